@@ -18,6 +18,12 @@
 ***************************************************************************/
 
 #include "zfuncs.h"
+#include <dirent.h>
+#include <dlfcn.h>                                                               //  optional xz, zstd libraries
+#include <zlib.h>
+#include <sched.h>                                                               //  CPU affinity
+#include <sys/vfs.h>                                                             //  statfs(), file system type
+#include <sys/sysmacros.h>
 
 #define findwild_release "findwild-2.7"                  //  version
 #define Tmax 500                                         //  max. dialog entry text cc
@@ -31,6 +37,15 @@
 #define ignore_rec_all     3                             //  ignore files with all ignore strings in one record
 #define ignore_match_any   4                             //  ignore match record with any ignore string
 #define ignore_match_all   5                             //  ignore match record with all ignore strings
+                                                         //  command line output formats:         2.8
+#define out_text           0                             //  search report
+#define out_jsonl          1                             //  JSON lines: matching and context records
+#define out_null           2                             //  file names with NUL terminators
+#define out_vimgrep        3                             //  file:line:column:record
+                                                         //  search stopped by a limit:           2.8
+#define limit_files        1                             //  max. files found
+#define limit_hits         2                             //  max. matches (file match counts)
+#define limit_deadline     3                             //  max. search time
 
 PangoFontDescription    *font;
 GtkWidget      *mWin, *mVbox, *mScroll, *mLog;                                   //  main window widgets
@@ -51,23 +66,68 @@ void m_quit();
 
 int search_dialog_event(zdialog *zd, cchar *event);                              //  widget event response function
 void break_criteria(char *string, char *strings[Smax], int &count);              //  break search/ignore strings into substrings
-void filescan();                                                                 //  directory / file name search
+int filescan();                                                                  //  directory / file name search
+int search_limit(int fcount, int64 nhits);                                       //  test search limits, set Flimit
+uint64 criteria_hash();                                                          //  hash of search criteria
 int filesearch(cchar *file);                                                     //  search file for matching string
 int search_dialog_stuff(zdialog *zd);                                            //  search criteria >> dialog widgets
 int search_dialog_fetch(zdialog *zd);                                            //  dialog widgets >> search criteria
 void load_file(zdialog *zd);                                                     //  load criteria from a file
 int load_file2(cchar *file);
 void save_file(zdialog *zd);                                                     //  save criteria to a file
+int batch_main(int argc, char *argv[]);                                          //  command line search, no GUI         2.8
+void batch_kill(int sig);                                                        //  signal: kill search, checkpoint
+void log_append(int bold, cchar *format, ...);                                   //  output to window or stdout          2.8
+void log_append2(int bold, cchar *format, ...);                                  //    " and scroll window to end
+void log_error(cchar *format, ...);                                              //  error to popup or stderr
+void latency_add(double secs);                                                   //  per-file latency (benchmark)
+void hit_add();                                                                  //  time file found (benchmark)
+void stats_report();                                                             //  search statistics report
+void stats_json(FILE *fid);                                                      //  search statistics, JSON format
+void out_file(cchar *file, int count);                                           //  output file found (not text format)
+void out_record(cchar *file, int line, char *record, int match);                 //  output matching or context record
+void out_end(int fcount);                                                        //  output end of search
+void json_string(FILE *fid, cchar *string);                                      //  output string in JSON format
+void recsearch(char *buff, int Rmatch[], int nsrs, int Rignore[], int nigs,      //  search record for search and ignore
+               int &recmatch, int &recignore);                                   //    strings, counts found
+int recspans(char *record, int spans[][2], int maxspans);                        //  positions of matching strings
+void delims_init();                                                              //  delimiter tables from delims        2.8
+void literal_init();                                                             //  literal scan or tokenize all
+void order_init();                                                               //  order strings by selectivity
+int delim_utf8(int code);                                                        //  test if code point is a delimiter
+int delim_check(cchar *string, cchar *what);                                     //  check string for delimiters
+int rectokens(cchar *record, int reccc, char *tokbuff, int maxcc,                //  break UTF-8 record into tokens
+              char *tokens[], int spans[][2], int maxtok, int fold);
+int recsegment(cchar *record, int cc, int maxcc);                                //  next record segment to tokenize
+int bench_main(int argc, char *argv[]);                                          //  benchmark program findwild-bench
 
 int         matchrule, ignorerule;                                               //  match and ignore rules from dialog
 char        sr_path[Tmax], sr_file[Tmax], sr_string[Tmax];                       //  search strings from dialog
 char        ig_file[Tmax], ig_string[Tmax];                                      //  ignore strings
 char        delims[100];                                                         //  string delimiters
+uchar       delimtab[128];                                                       //  ASCII delimiters (UTF-8 mode)       2.8
+int         udelims[100], nudelims;                                              //  non-ASCII delimiter code points
+int         Fdelimpunct;                                                         //  Unicode punctuation is a delimiter
 char        date_from[20], date_to[20];                                          //  date range, string format
 time_t      dt_from, dt_to;                                                      //  date range, binary format
 int         Fhits;                                                               //  flag, search prior search hits
 bool        FignorecaseF = false;                                                //  flag, ignore case searching files
 bool        FignorecaseS = false;                                                //  flag, ignore case searching strings
+bool        Futf8 = false;                                                       //  flag, UTF-8 text mode              2.8
+bool        Funique = false;                                                     //  flag, report each physical file once
+bool        Fgitignore = false;                                                  //  flag, use .gitignore etc. files
+bool        Funpack = true;                                                      //  flag, search compressed files
+bool        Farchive = false;                                                    //  flag, search archive members
+int         Findex = 0;                                                          //  token index, 1 = use, 2 = update
+char        indexDir[1000];                                                      //  token index files
+int         maxfiles = 0, maxhits = 0;                                           //  search limits, 0 = none            2.8
+double      deadline = 0, Tdeadline = 0;                                         //  max. secs, end time
+double      Tfiledeadline = 0;                                                   //  end time, also inside a file
+int         Flimit = 0;                                                          //  search stopped by limit_xxx
+int         Fstopped = 0;                                                        //  filesearch() stopped inside file
+int         Fcontinue = 0;                                                       //  continue stopped search
+double      checksecs = 30, Tcheckpoint = 0;                                     //  checkpoint interval, next time
+char        checkpointFile[1000];                                                //  where the search stopped
 
 cchar  *mstext[3] = { "any search string", "all search strings",
                       "all search strings in same record" };
@@ -77,14 +137,20 @@ cchar  *igtext[5] = { "any ignore string", "all ignore strings",
                       "with any ignore string",
                       "with all ignore strings" };
 
+cchar  *limittext[3] = { "max. files found", "max. matches found", "deadline reached" };
+
 cchar  defaultdelims[] = " =()[]{}.,;:'<>!-+*/|~`%^&?\\\"";
 
 char        *srfiles[Smax], *srstrings[Smax];                                    //  0-Smax search files and strings
 char        *igfiles[Smax], *igstrings[Smax];                                    //  0-Smax ignore files and strings
 int         nsrf, nsrs, nigf, nigs;                                              //  actual counts
+Zarena      Sarena = { 4096 };                                                   //  per search memory, criteria   2.8
+Zarena      Farena = { 262144 };                                                 //  per file memory, records
 
-int         dialogbusy = 0, killsearch = 0;                                      //  flags
+int         dialogbusy = 0;                                                      //  flags
+volatile sig_atomic_t   killsearch = 0;                                          //  set by signal handler, read by chunk workers
 int         listmatch = 0;
+int         Ffiles = 0;                                                          //  file names only, no match counts
 int         listprec = 0;
 int         listfoll = 0;
 
@@ -94,6 +160,406 @@ char        hitsFile2[1000];
 char        workbuff[1000];
 char        workbuff2[1000];
 
+int         Fbatch = 0;                                                          //  flag, command line search, no GUI   2.8
+FILE        *outfid = 0;                                                         //  batch mode output (stdout)
+int         outformat = out_text;                                                //  batch mode output format
+double      *Flatency = 0;                                                       //  opt. per-file search latency, secs.
+int         Nlatency = 0, Mlatency = 0;                                          //    count and capacity
+double      *Fhittime = 0;                                                       //  opt. time each file found, secs.
+int         Nhittime = 0, Mhittime = 0;                                          //    count and max. count
+
+struct search_stats {                                                            //  search statistics                  2.8
+   double   Twall, Tcpu;                                                         //  total elapsed and CPU time
+   double   Twalk, Tname, Tstat, Tread, Ttoken, Tmatch, Tout;                    //  time per search phase
+   int64    Nwalk;                                                               //  files from walker or hits list
+   int64    Ndirs, Nentries, Nwstat;                                             //  walker: folders, entries, stat() calls
+   int64    Nsearch, Nrecs, Nbytes;                                              //  files, records, bytes searched
+   int64    Xname, Xdate, Xstat, Xopen;                                          //  files skipped, per reason
+   int64    Xnomatch, Xignore;                                                   //  files rejected by search rules
+   int64    Xdup, Xloop;                                                         //  walker skips: duplicate, symlink loop
+   int64    Nigfiles, Xprune, Xigfile;                                           //  ignore files, folders/files skipped
+   int64    Nunpack, Nzbytes, Xunpack;                                           //  compressed files, bytes, errors
+   int64    Narc, Nmember, Xarc;                                                 //  archives, members listed, errors
+   int64    Nmemo, Hmemo;                                                        //  token match cache: lookups, hits
+   int64    Nsettle, Nfstop;                                                     //  early exit: records, files
+   int64    Npfile, Npchunk, Npthread;                                           //  large files in chunks, chunks, max. threads
+   int64    Nalloc[6];                                                           //  zmalloc_counts() during the search
+};
+
+int            Fstats = 0;                                                       //  collect search statistics, 1 = report
+search_stats   stats;
+thread_local search_stats *rstats = &stats;                                      //  recsearch() counters (chunk workers)
+
+#define recsmall  65536                                                          //  read smaller files, map larger
+#define listmax   9999                                                           //  max. preceding/following records
+#define recsegcc  999                                                            //  search long records in segments
+#define memoslots 4096                                                           //  token match cache size
+#define memocc    46                                                             //  max. token length cached
+#define memocost  12                                                             //  min. match cost to use the cache
+
+struct tokmemo {                                                                 //  token match cache entry            2.8
+   uint64   hash;                                                                //  token hash
+   uint32   gen;                                                                 //  file generation, 0 = empty
+   uint16   mbits, ibits;                                                        //  search, ignore strings matched
+   uchar    cc;                                                                  //  token length
+   char     text[memocc+1];
+};
+
+thread_local tokmemo *memo = 0;                                                  //  direct mapped, reset per file
+thread_local uint32 memogen = 1;                                                 //  (per thread: chunk workers)
+int         Fmemo = 0;                                                           //  use token match cache
+
+struct recfile {                                                                 //  file records reader                2.8
+   int      fd;
+   int      mapped;                                                              //  1 = whole file mapped
+   char     *data;                                                               //  mapped file or block buffer
+   int64    base, end;                                                           //  file offsets of data[0], data end
+   int64    pos;                                                                 //  file offset of next record
+   int64    cap;                                                                 //  data capacity
+   int      eof;                                                                 //  no more data to read
+   struct unpack  *zs;                                                           //  compressed file decompression
+   struct arcfile *arc;                                                          //  archive member reader
+   int      arcown;                                                              //  archive opened for this member
+};
+
+#define unpack_gzip  1                                                           //  compressed file types
+#define unpack_xz    2
+#define unpack_zstd  3
+#define unpackcc     262144                                                      //  decompressed block size
+#define unpackblks   4                                                           //  blocks per file, bounded memory
+#define unpackincc   65536                                                       //  compressed input read size
+
+struct unpackblk {                                                               //  decompressed data block            2.8
+   int      cc;
+   char     data[unpackcc];
+};
+
+struct unpack {                                                                  //  decompression of one file          2.8
+   int         type;                                                             //  unpack_gzip/xz/zstd
+   int         fd;                                                               //  compressed input
+   cchar       *input;                                                           //  first input: mapped file
+   int64       incc;                                                             //    or first block read
+   char        *map;                                                             //  mapped file, to unmap
+   int64       mapcc;
+   char        *inbuff;                                                          //  input buffer for read()
+   Zqueue      full, empty;                                                      //  decompressed blocks, free blocks
+   unpackblk   *blocks[unpackblks];
+   unpackblk   *curr;                                                            //  block being read from
+   int         currpos;
+   int         done;                                                             //  no more blocks
+   int         error;                                                            //  corrupt data, read error
+   int         cancel;                                                           //  stop worker thread
+   int64       Nin;                                                              //  compressed bytes read
+   pthread_t   tid;                                                              //  worker thread
+};
+
+int unpack_type(cchar *data, int64 cc);                                          //  compressed type from magic bytes
+unpack * unpack_open(int type, int fd, cchar *input, int64 incc);                //  start decompression worker
+int64 unpack_read(unpack *zs, char *buff, int64 cc);                             //  read decompressed data
+void unpack_close(unpack *zs);                                                   //  stop worker, free memory
+
+#define arc_tar      1                                                           //  archive types
+#define arc_zip      2
+#define arcbuffcc    65536                                                       //  tar input buffer
+
+struct arcfile {                                                                 //  tar or zip archive reader          2.8
+   int         type;                                                             //  arc_tar, arc_zip
+   int         fd;
+   char        *path;                                                            //  archive file path
+   unpack      *zs;                                                              //  compressed tar: decompressed data
+   char        *buff;                                                            //  tar: input buffer
+   int         bpos, bend;
+   int         mpad;                                                             //  tar: member padding to 512 bytes
+   int64       filecc;                                                           //  tar: file size, if not compressed
+   char        *map;                                                             //  zip: mapped file
+   int64       mapcc;
+   int64       cdpos, cdend;                                                     //  zip: next central directory entry
+   int64       Nleft;                                                            //  zip: entries left
+   cchar       *zdata;                                                           //  zip member: compressed data
+   int64       zcc, zpos;
+   int         method;                                                           //  zip member: stored, deflated
+   z_stream    gz;                                                               //  zip member: inflate state
+   int         gzopen;
+   char        name[XFCC];                                                       //  member name
+   int64       mcc, mread;                                                       //  member size, bytes read
+   time_t      mtime;                                                            //  member mod time
+   int         error;                                                            //  corrupt archive
+};
+
+int arc_type(cchar *name, int cc);                                               //  archive type from file name
+int arc_split(cchar *file);                                                      //  archive path cc in archive//member
+arcfile * arc_open(cchar *file, int type);                                       //  open archive, null if not valid
+cchar * arc_next(arcfile *arc);                                                  //  next member name, null = done
+int64 arc_read(arcfile *arc, char *buff, int64 cc);                              //  read member data
+void arc_close(arcfile *arc);                                                    //  close archive
+
+struct recview {                                                                 //  record view into file data         2.8
+   int64    offset;                                                              //  file offset
+   int      cc;                                                                  //  length
+   int      line;                                                                //  line number
+};
+
+struct litscan {                                                                 //  literal string scan, per file      2.8
+   cchar    *text;                                                               //  longest literal part of a search
+   int      cc;                                                                  //    or ignore string
+   int64    hit;                                                                 //  file offset of next hit, -1 = none
+   int64    from;                                                                //  scan from file offset
+};
+
+#define litmin  3                                                                //  min. literal length for literal scan
+
+litscan     literals[2*Smax];                                                    //  literals of search and ignore strings
+int         nlits;
+int         Fliteral = 0;                                                        //  use literal scan, not all records
+int         strorder[2*Smax];                                                    //  search, ignore strings (nsrs + ii)
+
+int recfile_open(recfile &rf, cchar *file);                                      //  open file for reading records
+void recfile_fill(recfile &rf, int64 keep);                                      //  read more data
+int recfile_next(recfile &rf, int64 keep, int64 &offset, int &cc);               //  get next record view
+int recfile_skip(recfile &rf, litscan lits[], int nlits, int fold);              //  skip to next record with a literal
+char * recfile_string(recfile &rf, int64 offset, int cc, char *&buff, int &cap); //  copy record view to string
+void recfile_close(recfile &rf);                                                 //  close file
+int filesearch_done(int Fmatch[], int Fignore[], recfile &rf, int scanned);      //  file found, rest need not be read
+
+#define parfilecc    (64 * 1024 * 1024)                                          //  search larger files in chunks
+#define parchunkcc   (8 * 1024 * 1024)                                           //  chunk size, extended to a record end
+#define parmax       16                                                          //  max. threads for one file
+
+int         filethreads = 0;                                                     //  threads for a large file, 0 = auto
+
+struct parmatch {                                                                //  matching record in a chunk         2.8
+   int64    offset;                                                              //  file offset
+   int      cc;                                                                  //  length
+   int      line;                                                                //  line number in chunk
+};
+
+struct parchunk {                                                                //  large file chunk for a worker      2.8
+   int64    begin, end;                                                          //  file offsets, end after a record
+   int      filematch, ignored, stopped;                                         //  matches, file rejected, 1/2 = kill/deadline
+   int      Fmatch[Smax], Fignore[Smax];                                         //  search and ignore strings in chunk
+   int      lines;                                                               //  pass 2: records in chunk
+   parmatch *matches;                                                            //    matching records
+   int      nmatch, mmatch;                                                      //    count and capacity
+   int      done;                                                                //  chunk is searched
+   double   Twork, Tcpu;                                                         //  worker elapsed and CPU secs
+   search_stats   st;                                                            //  worker counters and times
+};
+
+struct parfile {                                                                 //  large file searched in chunks      2.8
+   cchar       *data;                                                            //  mapped file
+   int64       cc;
+   int         pass;                                                             //  1 = file rules, 2 = list records
+   parchunk    *chunks;
+   int         nchunks, nqueued;                                                 //  chunks, chunks given to workers
+   int         nadvised;                                                         //  chunks read ahead (madvise)
+   int         nthreads;                                                         //  workers started
+   int         limit, active;                                                    //  workers allowed to search, searching
+   int         Rchunks;                                                          //  round of chunks for fstune_adjust()
+   int64       Rbytes;
+   double      Rwork, Rcpu, Tround;                                              //    worker secs, CPU secs, start time
+   int         stop;                                                             //  workers skip the other chunks
+   Zqueue      work;                                                             //  chunks to search
+   pthread_mutex_t   lock;                                                       //  chunk done
+   pthread_cond_t    cond;
+   pthread_t   tids[parmax];
+};
+
+#define fs_memory    0                                                           //  file system kinds, fstune
+#define fs_ssd       1                                                           //  (local, not rotational or unknown)
+#define fs_disk      2                                                           //  (local, rotational)
+#define fs_network   3                                                           //  (also FUSE)
+#define fsaheadmax   8                                                           //  max. chunks read ahead
+
+struct fstune {                                                                  //  large file concurrency, per root   2.8
+   char     fsname[20];                                                          //  file system type (statfs)
+   int      kind;                                                                //  fs_memory/ssd/disk/network
+   int      cpus;                                                                //  usable CPUs: affinity, cgroup quota
+   double   quota;                                                               //  cgroup CPU quota, 0 = none
+   int      fixed;                                                               //  workers from --file-threads
+   int      maxthreads;                                                          //  workers started for a file
+   int      threads, depth;                                                      //  workers searching, chunks read ahead
+   int      threads0, depth0;                                                    //    start values
+   int64    Nup, Ndown, Nrounds;                                                 //  increases, decreases, rounds
+   double   rate;                                                                //  last round, bytes/sec, 0 = none
+};
+
+fstune      tune;
+cchar       *fskinds[4] = { "memory", "local SSD", "local disk", "network" };
+
+int cpu_count(double &quota);                                                    //  usable CPUs, affinity and cgroup
+void fstune_open(cchar *path);                                                   //  file system of search root
+void fstune_adjust(double rate, double Twork, double Tcpu);                      //  AIMD after a round of chunks
+int parfile_use(recfile &rf);                                                    //  search file in chunks, in parallel
+int parfile_search(recfile &rf, int Fmatch[], int Fignore[], int &ignored);      //  pass 1: strings found in file
+int parfile_list(recfile &rf, cchar *filename);                                  //  pass 2: list matching records
+
+#define indexmagic  "FWINDEX1"                                                   //  token index file format
+
+struct idxhead {                                                                 //  token index file header            2.8
+   char     magic[8];
+   int64    nfiles, ntokens;                                                     //  files, distinct tokens
+   int64    keyoff, fileoff, pathoff;                                            //  section file offsets
+   int64    postoff, tokoff, vocoff, end;
+};
+
+struct idxfile {                                                                 //  indexed file
+   int64    mtime;                                                               //  mod time (member date)
+   int64    stime, ssize;                                                        //  file stamp, ns mod time and size
+   int64    path;                                                                //  path offset in paths
+   int      seq;                                                                 //  walk order
+   int      spare;
+};
+
+struct idxtoken {                                                                //  vocabulary entry
+   int64    str;                                                                 //  token offset in tokens
+   int64    post, postcc;                                                        //  postings in postings
+};
+
+struct fwindex {                                                                 //  mapped token index
+   char     *map;
+   int64    mapcc;
+   idxhead  *head;
+   idxfile  *files;
+   char     *paths;
+   uchar    *posts;
+   char     *tokens;
+   idxtoken *vocab;                                                              //  tokens, sorted
+};
+
+void index_file(char *root, char *key, char *file);                              //  index folder, key, file
+int index_open(fwindex &fx, cchar *file, cchar *key);                            //  map index file, check key
+void index_close(fwindex &fx);                                                   //  unmap
+int index_update(cchar *root, cchar *key, cchar *file);                          //  build or update index
+int index_search(FILE *fid);                                                     //  search files with index
+
+#define inodeshards  16                                                          //  (dev, ino) set shards
+
+struct inodeset {                                                                //  concurrent (dev, ino) set          2.8
+   pthread_mutex_t   lock[inodeshards];
+   Zhash             *table[inodeshards];
+};
+
+void inodeset_open(inodeset &set);                                               //  make empty set
+int inodeset_key(char key[12], dev_t dev, ino_t ino);                            //  make key, return shard
+int inodeset_add(inodeset &set, dev_t dev, ino_t ino);                           //  add (dev, ino), 0 if already present
+void inodeset_close(inodeset &set);                                              //  free set
+
+struct igrule {                                                                  //  compiled ignore file rule          2.8
+   char     *pattern;
+   int      type;                                                                //  rule_literal/suffix/glob
+   int      negate;                                                              //  ! rule: do not ignore
+   int      dironly;                                                             //  trailing '/': folders only
+   int      anchored;                                                            //  has '/': path from rule folder
+};
+
+#define rule_literal 1                                                           //  name or path, no wildcards
+#define rule_suffix  2                                                           //  *suffix, no other wildcards
+#define rule_glob    3                                                           //  general: * ? [...] **
+
+struct ignoreset {                                                               //  ignore rules of a folder           2.8
+   ignoreset   *parent;                                                          //  rules of folders above
+   int         basecc;                                                           //  folder path cc, with '/'
+   int         nrules;
+   igrule      *rules;
+};
+
+struct walkdir {                                                                 //  directory in walk frontier         2.8
+   char        *path;
+   walkdir     *parent;                                                          //  parent directory, loop check
+   ignoreset   *ignore;                                                          //  ignore rules for entries
+   dev_t       dev;                                                              //  device and inode, set when opened
+   ino_t       ino;
+   int64       mtime;                                                            //  walk_recent: mod time, nanosecs
+   int64       seq;                                                              //    order added, for equal times
+};
+
+struct walkfile {                                                                //  file of folder, walk_small         2.8
+   int64       size;
+   int         name;                                                             //  offset in filewalk.bnames
+   dev_t       dev;
+   ino_t       ino;
+};
+
+#define walk_nocase     1                                                        //  walk_open() options: ignore case
+#define walk_unique     2                                                        //  report each physical file once
+#define walk_gitignore  4                                                        //  use .gitignore etc. files
+#define walk_archive    8                                                        //  list members of archive files
+#define walk_track      16                                                       //  keep position for walk_save()
+#define walk_order      96                                                       //  frontier order (option field):
+#define walk_dfs        0                                                        //    depth first, readdir order
+#define walk_bfs        32                                                       //    breadth first
+#define walk_recent     64                                                       //    recently modified folders first
+#define walk_small      96                                                       //    depth first, small files first
+
+int         walkorder = walk_dfs;                                                //  search walk order                  2.8
+cchar       *ordernames[4] = { "depth", "breadth", "recent", "small" };          //  walkorder / walk_bfs
+
+struct filewalk {                                                                //  file tree walker                   2.8
+   cchar    *wpath;                                                              //  wildcard path to match
+   int      nocase;                                                              //  ignore case of file names
+   int      unique;                                                              //  report each physical file once
+   int      gitignore;                                                           //  use ignore files
+   int      archives;                                                            //  list archive members
+   DIR      *dir;                                                                //  directory being read
+   walkdir  *curr;                                                               //  and its frontier entry
+   walkdir  **frontier;                                                          //  directories to read (stack)
+   int      Nfront, Mfront;                                                      //  count and capacity
+   int      order;                                                               //  walk_dfs/bfs/recent/small
+   int      Nhead;                                                               //  walk_bfs: next to read (queue)
+   int64    Nseq;                                                                //  walk_recent: folders added (heap)
+   int      Npush;                                                               //  frontier count when curr opened
+   int      dircc;                                                               //  curr path cc, with '/'
+   Zarena   arena;                                                               //  frontier entries and paths
+   inodeset dirs, files;                                                         //  visited directories and files
+   char     **prune;                                                             //  ignore file patterns, prune folders
+   int      nprune;                                                              //    whose files would all match
+   int64    Ndirs, Nentries, Nstat;                                              //  directories, entries read, stat() calls
+   int64    Xdup, Xloop;                                                         //  skipped: duplicates, loops
+   int64    Nigfiles, Xprune, Xigfile;                                           //  ignore files read, folders/files skipped
+   arcfile  *arc;                                                                //  archive being listed
+   int      arccc;                                                               //  its path cc, with '//'
+   int64    arcdone;                                                             //  its members listed
+   int64    Narc, Nmember, Xarc;                                                 //  archives, members listed, errors
+   int      track;                                                               //  keep names read in curr
+   char     *names;                                                              //  names read, null terminated
+   int      namescc, namescap, namelast;                                         //  cc, capacity, last name
+   Zhash    *skip;                                                               //  curr names read before restore
+   walkfile *batch;                                                              //  walk_small: files of curr, by size
+   int      nbatch, mbatch, ibatch;                                              //    count, capacity, next to return
+   char     *bnames;                                                             //    their names
+   int      bnamescc, bnamescap;
+   char     file[XFCC];                                                          //  file path returned
+};
+
+void walk_open(filewalk &fw, cchar *wpath, int options);                         //  start walk, root from wpath
+cchar * walk_next(filewalk &fw);                                                 //  next matching file, null = done
+void walk_close(filewalk &fw);                                                   //  end walk
+void walk_push(filewalk &fw, walkdir *dd);                                       //  add folder to frontier
+walkdir * walk_pop(filewalk &fw);                                                //  next folder to read, null = none
+int walk_before(walkdir *d1, walkdir *d2);                                       //  walk_recent: d1 is read first
+void walk_batch(filewalk &fw, cchar *name, int64 size, dev_t dev, ino_t ino);    //  add file to walk_small batch
+ignoreset * ignore_load(filewalk &fw, walkdir *dd, int dfd);                     //  load ignore files of a folder
+int ignore_check(ignoreset *set, cchar *path, cchar *name, int isdir);           //  test folder entry, 1 = ignore
+int ignore_glob(cchar *pattern, cchar *string);                                  //  gitignore wildcard match, 1 = match
+int walk_prunedir(filewalk &fw, int cc);                                         //  test folder against prune patterns
+void walk_addname(filewalk &fw, cchar *name);                                    //  add to names read in curr
+void walk_save(filewalk &fw, FILE *fid, int done);                               //  save walk position, frontier
+int walk_restore(filewalk &fw, FILE *fid);                                       //  continue walk from walk_save()
+
+#define checkmagic  "FWCKPT01"                                                   //  checkpoint file format
+
+struct checkpoint {                                                              //  stopped search checkpoint          2.8
+   char     magic[8];
+   uint64   hash;                                                                //  criteria_hash()
+   int      hits;                                                                //  search of prior hits (Fhits)
+   int      sfile;                                                               //  search file (srfiles[])
+   int64    hitscc;                                                              //  search_hits output written
+   int64    hitspos;                                                             //  prior hits input read (Fhits)
+};
+
+int checkpoint_save(checkpoint &ck, filewalk *fw, int done);                     //  save search position
+int checkpoint_load(checkpoint &ck, FILE *&fid);                                 //  read checkpoint of stopped search
+
 /**
  * @brief main - main windowing program
  * @param argc
@@ -102,11 +568,18 @@ char        workbuff2[1000];
  */
 int main(int argc, char *argv[])
 {
+   #ifdef FWBENCH                                                                //  benchmark program findwild-bench   2.8
+      return bench_main(argc,argv);
+   #endif
+
    appimage_install("findwild");                                                 //  if appimage, menu integration      2.4
 
    if (argc > 1 && strmatch(argv[1],"-uninstall"))                               //  uninstall appimage                 2.4
       appimage_unstall();                                                        //  (does not return if uninstalled)
 
+   if (argc > 1 && strmatchN(argv[1],"--",2))                                    //  command line search, no GUI        2.8
+      return batch_main(argc,argv);
+
    setenv("GDK_BACKEND","x11",1);                                                //  fedora/wayland
    setenv("GTK_THEME","default",0);                                              //  KDE window  manager
 
@@ -182,6 +655,12 @@ int initfunc(void * data){
   *hitsFile = 0;                                                                //  set up search hits save file
   strncatv(hitsFile,999,get_zhomedir(),"/search_hits",null);
 
+  *indexDir = 0;                                                                 //  token index folder
+  strncatv(indexDir,999,get_zhomedir(),"/index",null);
+
+  *checkpointFile = 0;                                                           //  stopped search checkpoint
+  strncatv(checkpointFile,999,get_zhomedir(),"/search_checkpoint",null);
+
   if (*criteriaFile) {
     err = load_file2(criteriaFile);                                            //  load command line file
     if (err) {
@@ -258,6 +737,601 @@ void m_quit()
    return;
 }
 
+
+/***
+          command line search, no GUI
+
+          findwild --batch criteria-file [options]
+
+          The criteria file is made with the search dialog [save file] button.
+          The search runs without a window and the search report is written
+          to stdout. Messages from the program go to stderr.
+
+          Output formats other than text are for editors and scripts:
+            jsonl    one JSON object per line:
+                     {"type":"match","path":P,"line":N,"column":N,"text":T,"spans":[[B,E],..]}
+                     {"type":"context","path":P,"line":N,"text":T}
+                     {"type":"summary","files":N,"killed":false,"partial":false}
+                     spans are byte offsets [begin,end) of matching strings in the record,
+                     context records are from --prec and --foll
+            null     file path + NUL for each file found
+            vimgrep  path:line:column:record for each matching record
+          jsonl and vimgrep always list matching records (--list).
+          Output is written in large blocks, unless stdout is a terminal.
+
+          options:  --hits          search files found by previous search
+                    --list          list matching records
+                    -l, --files-with-matches
+                                    list file names only, without match
+                                    counts: a file is read up to the first
+                                    match that settles the search rules
+                    --prec N        with N preceding records (0-9999)
+                    --foll N        with N following records (0-9999)
+                    --format X      output format: text (search report), jsonl,
+                                    null (file names for xargs -0), vimgrep
+                    --output F      output to file F instead of stdout
+                    --utf8          UTF-8 text mode (as the search dialog option)
+                    --unique        search each physical file once, also if
+                                    reached by several symlinks or hard links
+                    --gitignore     skip files and folders given in .gitignore,
+                                    .ignore and .findwildignore files
+                    --raw           search compressed files (.gz .xz .zst)
+                                    as they are, without decompression
+                    --archives      search members of tar and zip files,
+                                    reported as archive.tar.gz//member
+                    --index         search with a token index of the search
+                                    path folder, made if missing
+                    --index-update  update the token index (new and changed
+                                    files), then search with it
+                    --max-files N   stop the search after N files found
+                    --max-hits N    stop after N matches (sum of file counts)
+                    --deadline S    stop the search after S seconds
+                    --continue      continue a search stopped by a limit,
+                                    killed or crashed, with the same criteria,
+                                    from its checkpoint
+                    --checkpoint S  save a checkpoint every S seconds
+                                    (default 30, 0 = only when stopped)
+                    --order X       folder walk order: depth (first, as find),
+                                    breadth (first), recent (recently modified
+                                    folders first), small (files of a folder
+                                    smallest first): first files found sooner
+                    --file-threads N  threads searching one large file
+                                    (64 MB or more) in chunks, 1 = none
+                                    (default: per file system and CPUs,
+                                    adjusted while searching, max. 16)
+                    --stats         add search statistics to the report
+                    --stats-json F  write search statistics to file F in JSON
+                                    format (F = "-": stdout, after the report)
+
+          exit status: 0 = files found, 1 = no files found, 2 = error
+***/
+
+cchar  *batch_usage =
+   "usage: findwild --batch criteria-file [--hits] [--list] [--prec N] [--foll N] \n"
+   "                [-l | --files-with-matches] \n"
+   "                [--format text|jsonl|null|vimgrep] [--output file] \n"
+   "                [--utf8] [--unique] [--gitignore] [--raw] [--archives] \n"
+   "                [--index] [--index-update] \n"
+   "                [--max-files N] [--max-hits N] [--deadline secs] [--continue] \n"
+   "                [--checkpoint secs] [--order depth|breadth|recent|small] \n"
+   "                [--file-threads N] \n"
+   "                [--stats] [--stats-json file] \n";
+
+//  SIGINT, SIGTERM: stop the search as the kill button, save a checkpoint
+//  (a second signal ends the program)
+
+void batch_kill(int sig)                                                         //  2.8
+{
+   killsearch = 1;
+   signal(sig,SIG_DFL);
+   return;
+}
+
+
+int batch_main(int argc, char *argv[])                                           //  2.8
+{
+   cchar    *file = 0, *jsonfile = 0, *outfile = 0;
+   cchar    *formats[4] = { "text", "jsonl", "null", "vimgrep" };
+   int      ii, jj, err, fcount, utf8 = 0, unique = 0, gitignore = 0, raw = 0;
+   int      archives = 0;
+   FILE     *fid;
+
+   for (ii = 1; ii < argc; ii++)                                                 //  parse command line options
+   {
+      if (strmatch(argv[ii],"--batch") && ii+1 < argc) file = argv[++ii];
+      else if (strmatch(argv[ii],"--hits")) Fhits = 1;
+      else if (strmatch(argv[ii],"--list")) listmatch = 1;
+      else if (strmatch(argv[ii],"-l")) Ffiles = 1;
+      else if (strmatch(argv[ii],"--files-with-matches")) Ffiles = 1;
+      else if (strmatch(argv[ii],"--prec") && ii+1 < argc) {
+         err = convSI(argv[++ii],listprec,0,listmax);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--foll") && ii+1 < argc) {
+         err = convSI(argv[++ii],listfoll,0,listmax);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--format") && ii+1 < argc) {
+         for (outformat = 0; outformat < 4; outformat++)
+            if (strmatch(argv[ii+1],formats[outformat])) break;
+         if (outformat == 4) break;
+         ii++;
+      }
+      else if (strmatch(argv[ii],"--output") && ii+1 < argc) outfile = argv[++ii];
+      else if (strmatch(argv[ii],"--utf8")) utf8 = 1;
+      else if (strmatch(argv[ii],"--unique")) unique = 1;
+      else if (strmatch(argv[ii],"--gitignore")) gitignore = 1;
+      else if (strmatch(argv[ii],"--raw")) raw = 1;
+      else if (strmatch(argv[ii],"--archives")) archives = 1;
+      else if (strmatch(argv[ii],"--index")) Findex = 1;
+      else if (strmatch(argv[ii],"--index-update")) Findex = 2;
+      else if (strmatch(argv[ii],"--max-files") && ii+1 < argc) {
+         err = convSI(argv[++ii],maxfiles,1,1000000000);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--max-hits") && ii+1 < argc) {
+         err = convSI(argv[++ii],maxhits,1,1000000000);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--deadline") && ii+1 < argc) {
+         err = convSD(argv[++ii],deadline,0.001,1.0e9);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--continue")) Fcontinue = 1;
+      else if (strmatch(argv[ii],"--checkpoint") && ii+1 < argc) {
+         err = convSD(argv[++ii],checksecs,0,1.0e9);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--order") && ii+1 < argc) {
+         for (jj = 0; jj < 4; jj++)
+            if (strmatch(argv[ii+1],ordernames[jj])) break;
+         if (jj == 4) break;
+         walkorder = jj * walk_bfs;
+         ii++;
+      }
+      else if (strmatch(argv[ii],"--file-threads") && ii+1 < argc) {
+         err = convSI(argv[++ii],filethreads,1,parmax);
+         if (err) break;
+      }
+      else if (strmatch(argv[ii],"--stats")) Fstats = 1;
+      else if (strmatch(argv[ii],"--stats-json") && ii+1 < argc) {
+         jsonfile = argv[++ii];
+         if (! Fstats) Fstats = 2;                                               //  JSON only
+      }
+      else break;                                                                //  unknown option
+   }
+
+   if (ii < argc || ! file) {
+      fprintf(stderr,"%s",batch_usage);
+      return 2;
+   }
+
+   if (outfile) {
+      outfid = fopen(outfile,"w");                                               //  search report >> file
+      if (! outfid) {
+         fprintf(stderr,"%s: %s \n",outfile,strerror(errno));
+         return 2;
+      }
+   }
+   else {
+      outfid = fdopen(dup(STDOUT_FILENO),"w");                                   //  search report >> stdout
+      if (! outfid) return 2;
+   }
+
+   if (! isatty(fileno(outfid)))                                                 //  large writes, no flush per line
+      setvbuf(outfid,0,_IOFBF,256*1024);
+   dup2(STDERR_FILENO,STDOUT_FILENO);                                            //  zfuncs log messages >> stderr
+   Fbatch = 1;
+
+   zinitapp(findwild_release);                                                   //  set up app directories
+
+   *criteriaFile = 0;
+   initfunc(0);                                                                  //  defaults, search hits file
+
+   err = load_file2(file);                                                       //  load search criteria
+   if (err) {
+      fprintf(stderr,"%s: %s \n",file,strerror(err));
+      return 2;
+   }
+
+   if (utf8) Futf8 = 1;                                                          //  override criteria file
+   if (unique) Funique = 1;
+   if (gitignore) Fgitignore = 1;
+   if (raw) Funpack = 0;
+   if (archives) Farchive = 1;
+
+   if (outformat == out_null) listmatch = 0;                                     //  file names only
+   if (outformat == out_null) Ffiles = 1;
+   if (outformat == out_jsonl || outformat == out_vimgrep) listmatch = 1;        //  matching records
+   if (listmatch) Ffiles = 0;
+
+   signal(SIGINT,batch_kill);                                                    //  stop with a checkpoint
+   signal(SIGTERM,batch_kill);
+
+   fcount = filescan();                                                          //  do the search
+
+   if (jsonfile && fcount >= 0) {                                                //  search statistics, JSON format
+      if (strmatch(jsonfile,"-")) stats_json(outfid);
+      else {
+         fid = fopen(jsonfile,"w");
+         if (! fid) fprintf(stderr,"%s: %s \n",jsonfile,strerror(errno));
+         else {
+            stats_json(fid);
+            fclose(fid);
+         }
+      }
+   }
+
+   fclose(outfid);
+
+   if (fcount < 0) return 2;
+   if (fcount == 0) return 1;
+   return 0;
+}
+
+
+/**
+ * @brief log_append - append search output to main window or stdout (batch mode)
+ * @param bold
+ * @param format
+ */
+void log_append(int bold, cchar *format, ...)                                    //  2.8
+{
+   va_list     arglist;
+   char        buff[2000];
+   double      time0 = 0;
+
+   if (Fbatch && outformat != out_text) return;                                  //  other output format
+   if (Fstats) time0 = get_seconds();
+
+   va_start(arglist,format);
+   if (Fbatch) vfprintf(outfid,format,arglist);
+   else {
+      vsnprintf(buff,2000,format,arglist);
+      textwidget_append(mLog,bold,"%s",buff);
+   }
+   va_end(arglist);
+
+   if (Fstats) stats.Tout += get_seconds() - time0;                              //  output time
+   return;
+}
+
+
+/**
+ * @brief log_append2 - same as log_append, and scroll the main window to the end
+ * @param bold
+ * @param format
+ */
+void log_append2(int bold, cchar *format, ...)                                   //  2.8
+{
+   va_list     arglist;
+   char        buff[2000];
+   double      time0 = 0;
+
+   if (Fbatch && outformat != out_text) return;                                  //  other output format
+   if (Fstats) time0 = get_seconds();
+
+   va_start(arglist,format);
+   if (Fbatch) vfprintf(outfid,format,arglist);
+   else {
+      vsnprintf(buff,2000,format,arglist);
+      textwidget_append2(mLog,bold,"%s",buff);
+   }
+   va_end(arglist);
+
+   if (Fstats) stats.Tout += get_seconds() - time0;                              //  output time
+   return;
+}
+
+
+/**
+ * @brief log_error - error message to popup window or stderr (batch mode)
+ * @param format
+ */
+void log_error(cchar *format, ...)                                               //  2.8
+{
+   va_list     arglist;
+   char        buff[1000];
+
+   va_start(arglist,format);
+   vsnprintf(buff,1000,format,arglist);
+   va_end(arglist);
+
+   if (Fbatch) fprintf(stderr,"%s \n",buff);
+   else zmessageACK(mWin,"%s",buff);
+   return;
+}
+
+
+/**
+ * @brief latency_add - record per-file search time (benchmark only)
+ * @param secs
+ */
+void latency_add(double secs)                                                    //  2.8
+{
+   double   *pp;
+
+   if (Nlatency == Mlatency) {                                                   //  expand as needed
+      Mlatency = 2 * Mlatency + 10000;
+      pp = (double *) zmalloc(Mlatency * sizeof(double));
+      memcpy(pp,Flatency,Nlatency * sizeof(double));
+      zfree(Flatency);
+      Flatency = pp;
+   }
+
+   Flatency[Nlatency++] = secs;
+   return;
+}
+
+
+/**
+ * @brief hit_add - record the time a matching file is found (benchmark only)
+ *        the first Mhittime files are kept, for latency to first and k hits
+ */
+void hit_add()                                                                   //  2.8
+{
+   if (Nhittime < Mhittime) Fhittime[Nhittime++] = get_seconds();
+   return;
+}
+
+
+/**
+ * @brief stats_report - add search statistics to the search report
+ *        The phase times are measured around each step of the search, so the
+ *        timing itself adds some overhead. Time not in any phase is "other"
+ *        (GUI updates, file rules and bookkeeping).
+ */
+void stats_report()                                                              //  2.8
+{
+   double   Tphase[8], Tother, Tsum = 0;
+   cchar    *phase[8] = { "traversal", "name filter", "stat/date filter", "open/read",
+                          "tokenize", "match", "output", "other" };
+   int      ii;
+
+   Tphase[0] = stats.Twalk;
+   Tphase[1] = stats.Tname;
+   Tphase[2] = stats.Tstat;
+   Tphase[3] = stats.Tread;
+   Tphase[4] = stats.Ttoken;
+   Tphase[5] = stats.Tmatch;
+   Tphase[6] = stats.Tout;
+   for (ii = 0; ii < 7; ii++) Tsum += Tphase[ii];
+   Tother = stats.Twall - Tsum;
+   if (Tother < 0) Tother = 0;
+   Tphase[7] = Tother;
+
+   log_append(0,"\n search statistics \n");
+   log_append(0,"   files listed: %ld  searched: %ld  records: %ld  bytes: %ld \n",
+                  stats.Nwalk, stats.Nsearch, stats.Nrecs, stats.Nbytes);
+   log_append(0,"   files skipped: file name %ld  date %ld  stat error %ld  open error %ld \n",
+                  stats.Xname, stats.Xdate, stats.Xstat, stats.Xopen);
+   log_append(0,"   files rejected: no match %ld  ignore string %ld \n",
+                  stats.Xnomatch, stats.Xignore);
+   log_append(0,"   folders read: %ld  entries: %ld  stat calls: %ld  folders skipped: %ld \n",
+                  stats.Ndirs, stats.Nentries, stats.Nwstat, stats.Xprune);
+   log_append(0,"   links skipped: duplicate %ld  symlink loop %ld \n",stats.Xdup,stats.Xloop);
+   if (Fgitignore)
+      log_append(0,"   ignore files read: %ld  files skipped: %ld \n",
+                     stats.Nigfiles, stats.Xigfile);
+   if (stats.Nunpack)
+      log_append(0,"   compressed files: %ld  compressed bytes: %ld  errors: %ld \n",
+                     stats.Nunpack, stats.Nzbytes, stats.Xunpack);
+   if (stats.Narc)
+      log_append(0,"   archives read: %ld  members listed: %ld  errors: %ld \n",
+                     stats.Narc, stats.Nmember, stats.Xarc);
+   log_append(0,"   record search: %s \n",Fliteral ? "literal scan, records with hits"
+                                                   : "all records tokenized");
+   if (stats.Nmemo)
+      log_append(0,"   token match cache: lookups %ld  hits %ld (%.1f %%) \n",
+                     stats.Nmemo, stats.Hmemo, 100.0 * stats.Hmemo / stats.Nmemo);
+   if (stats.Nsettle + stats.Nfstop)
+      log_append(0,"   early exit: records settled %ld  files decided %ld \n",
+                     stats.Nsettle, stats.Nfstop);
+   if (stats.Npfile)
+      log_append(0,"   large files in chunks: %ld  chunks: %ld  threads: %ld \n",
+                     stats.Npfile, stats.Npchunk, stats.Npthread);
+   log_append(0,"   file system: %s (%s)  CPUs: %d",tune.fsname,fskinds[tune.kind],tune.cpus);
+   if (tune.quota) log_append(0," (cgroup quota %.2f)",tune.quota);
+   log_append(0," \n");
+   log_append(0,"   large file workers: %d (start %d, max. %d%s)  chunks read ahead: %d (start %d) \n",
+                  tune.threads, tune.threads0, tune.maxthreads, tune.fixed ? ", fixed" : "",
+                  tune.depth, tune.depth0);
+   if (tune.Nrounds)
+      log_append(0,"   workers adjusted: rounds %ld  increased %ld  decreased %ld \n",
+                     tune.Nrounds, tune.Nup, tune.Ndown);
+   log_append(0,"   memory allocations: %ld  frees: %ld  pool reuse: %ld (%.0f %%) \n",
+                  stats.Nalloc[0], stats.Nalloc[1], stats.Nalloc[2],
+                  stats.Nalloc[0] ? 100.0 * stats.Nalloc[2] / stats.Nalloc[0] : 0.0);
+   log_append(0,"   memory large blocks: %ld  bytes in use: %ld  meminfo reads: %ld \n",
+                  stats.Nalloc[3], stats.Nalloc[4], stats.Nalloc[5]);
+
+   for (ii = 0; ii < 8; ii++)
+      log_append(0,"   %-18s %9.3f secs %5.1f %% \n",phase[ii],Tphase[ii],
+                     stats.Twall > 0 ? 100.0 * Tphase[ii] / stats.Twall : 0.0);
+
+   log_append(0,"   %-18s %9.3f secs  CPU %.3f secs \n","total",stats.Twall,stats.Tcpu);
+   if (stats.Twall > 0)
+      log_append(0,"   %.0f files/sec  %.2f MB/sec \n",stats.Nsearch / stats.Twall,
+                                                       stats.Nbytes / stats.Twall / 1.0e6);
+   return;
+}
+
+
+/**
+ * @brief stats_json - write search statistics in JSON format
+ * @param fid
+ */
+void stats_json(FILE *fid)                                                       //  2.8
+{
+   fprintf(fid,"{\n");
+   fprintf(fid,"  \"files\": { \"listed\": %ld, \"searched\": %ld, \"records\": %ld, \"bytes\": %ld },\n",
+               stats.Nwalk, stats.Nsearch, stats.Nrecs, stats.Nbytes);
+   fprintf(fid,"  \"skipped\": { \"file_name\": %ld, \"date\": %ld, \"stat_error\": %ld, \"open_error\": %ld,"
+               " \"no_match\": %ld, \"ignore_string\": %ld },\n",
+               stats.Xname, stats.Xdate, stats.Xstat, stats.Xopen, stats.Xnomatch, stats.Xignore);
+   fprintf(fid,"  \"walk\": { \"folders\": %ld, \"entries\": %ld, \"stat_calls\": %ld, \"skipped_folders\": %ld,"
+               " \"duplicate\": %ld, \"symlink_loop\": %ld, \"ignore_files\": %ld, \"ignored_files\": %ld },\n",
+               stats.Ndirs, stats.Nentries, stats.Nwstat, stats.Xprune,
+               stats.Xdup, stats.Xloop, stats.Nigfiles, stats.Xigfile);
+   fprintf(fid,"  \"compressed\": { \"files\": %ld, \"bytes\": %ld, \"errors\": %ld },\n",
+               stats.Nunpack, stats.Nzbytes, stats.Xunpack);
+   fprintf(fid,"  \"archives\": { \"archives\": %ld, \"members\": %ld, \"errors\": %ld },\n",
+               stats.Narc, stats.Nmember, stats.Xarc);
+   fprintf(fid,"  \"record_search\": \"%s\",\n",Fliteral ? "literal" : "tokenize");
+   fprintf(fid,"  \"token_cache\": { \"lookups\": %ld, \"hits\": %ld },\n",
+               stats.Nmemo, stats.Hmemo);
+   fprintf(fid,"  \"early_exit\": { \"records\": %ld, \"files\": %ld },\n",
+               stats.Nsettle, stats.Nfstop);
+   fprintf(fid,"  \"large_files\": { \"files\": %ld, \"chunks\": %ld, \"threads\": %ld },\n",
+               stats.Npfile, stats.Npchunk, stats.Npthread);
+   fprintf(fid,"  \"concurrency\": { \"file_system\": \"%s\", \"kind\": \"%s\", \"cpus\": %d,"
+               " \"cgroup_quota\": %.2f, \"workers\": %d, \"workers_start\": %d, \"workers_max\": %d,"
+               " \"fixed\": %s, \"read_ahead\": %d, \"read_ahead_start\": %d, \"rounds\": %ld,"
+               " \"increased\": %ld, \"decreased\": %ld },\n",
+               tune.fsname, fskinds[tune.kind], tune.cpus, tune.quota, tune.threads, tune.threads0,
+               tune.maxthreads, tune.fixed ? "true" : "false", tune.depth, tune.depth0,
+               tune.Nrounds, tune.Nup, tune.Ndown);
+   fprintf(fid,"  \"memory\": { \"allocations\": %ld, \"frees\": %ld, \"pool_reuse\": %ld,"
+               " \"large_blocks\": %ld, \"bytes_in_use\": %ld, \"meminfo_reads\": %ld },\n",
+               stats.Nalloc[0], stats.Nalloc[1], stats.Nalloc[2], stats.Nalloc[3],
+               stats.Nalloc[4], stats.Nalloc[5]);
+   fprintf(fid,"  \"secs\": { \"traversal\": %.6f, \"name_filter\": %.6f, \"stat_filter\": %.6f,"
+               " \"open_read\": %.6f, \"tokenize\": %.6f, \"match\": %.6f, \"output\": %.6f,"
+               " \"wall\": %.6f, \"cpu\": %.6f }\n",
+               stats.Twalk, stats.Tname, stats.Tstat, stats.Tread, stats.Ttoken, stats.Tmatch,
+               stats.Tout, stats.Twall, stats.Tcpu);
+   fprintf(fid,"}\n");
+   return;
+}
+
+
+/**
+ * @brief out_file - output a file found, for output formats other than text
+ * @param file
+ * @param count  count of matching records
+ */
+void out_file(cchar *file, int count)                                            //  2.8
+{
+   double   time0 = 0;
+
+   if (Fstats) time0 = get_seconds();
+
+   if (outformat == out_null) {                                                  //  path + NUL
+      fputs(file,outfid);
+      putc_unlocked(0,outfid);
+   }
+
+   if (Fstats) stats.Tout += get_seconds() - time0;
+   return;
+}
+
+
+/**
+ * @brief out_record - output a matching or context record, for output formats other than text
+ * @param file
+ * @param line    record line number
+ * @param record
+ * @param match   1 = matching record, 0 = context record
+ */
+void out_record(cchar *file, int line, char *record, int match)                  //  2.8
+{
+   int      spans[100][2], nspans = 0, ii;
+   double   time0 = 0;
+
+   if (Fstats) time0 = get_seconds();
+
+   if (match) nspans = recspans(record,spans,100);                               //  matching strings in record
+
+   if (outformat == out_vimgrep && match)
+      fprintf(outfid,"%s:%d:%d:%s\n",file,line,nspans ? spans[0][0]+1 : 1,record);
+
+   if (outformat == out_jsonl)
+   {
+      fprintf(outfid,"{\"type\":\"%s\",\"path\":",match ? "match" : "context");
+      json_string(outfid,file);
+      fprintf(outfid,",\"line\":%d,",line);
+      if (match) fprintf(outfid,"\"column\":%d,",nspans ? spans[0][0]+1 : 1);
+      fputs("\"text\":",outfid);
+      json_string(outfid,record);
+      if (match) {
+         fputs(",\"spans\":[",outfid);
+         for (ii = 0; ii < nspans; ii++)
+            fprintf(outfid,"%s[%d,%d]",ii ? "," : "",spans[ii][0],spans[ii][1]);
+         putc_unlocked(']',outfid);
+      }
+      fputs("}\n",outfid);
+   }
+
+   if (Fstats) stats.Tout += get_seconds() - time0;
+   return;
+}
+
+
+/**
+ * @brief out_end - output end of search, for output formats other than text
+ * @param fcount  files found
+ */
+void out_end(int fcount)                                                         //  2.8
+{
+   if (outformat == out_jsonl)
+      fprintf(outfid,"{\"type\":\"summary\",\"files\":%d,\"killed\":%s,\"partial\":%s}\n",
+                      fcount, killsearch ? "true" : "false", Flimit ? "true" : "false");
+   return;
+}
+
+
+/**
+ * @brief json_string - output a string in JSON format, with quotes and escapes.
+ *        Invalid UTF-8 bytes are replaced with U+FFFD.
+ * @param fid
+ * @param string
+ */
+void json_string(FILE *fid, cchar *string)                                       //  2.8
+{
+   const uchar *pp = (const uchar *) string;
+   int      ii, cc;
+
+   putc_unlocked('"',fid);
+
+   while (*pp)
+   {
+      if (*pp == '"' || *pp == '\\') {                                           //  escape quote and backslash
+         putc_unlocked('\\',fid);
+         putc_unlocked(*pp++,fid);
+         continue;
+      }
+
+      if (*pp < 0x20) {                                                          //  control character
+         fprintf(fid,"\\u%04x",*pp++);
+         continue;
+      }
+
+      if (*pp < 0x80) {                                                          //  ASCII
+         putc_unlocked(*pp++,fid);
+         continue;
+      }
+
+      cc = 0;                                                                    //  UTF-8 sequence length
+      if (*pp >= 0xc2 && *pp <= 0xdf) cc = 2;
+      else if (*pp >= 0xe0 && *pp <= 0xef) cc = 3;
+      else if (*pp >= 0xf0 && *pp <= 0xf4) cc = 4;
+      for (ii = 1; ii < cc; ii++)
+         if ((pp[ii] & 0xc0) != 0x80) break;                                     //  (stops at null)
+
+      if (cc && ii == cc) {                                                      //  valid, copy
+         fwrite(pp,1,cc,fid);
+         pp += cc;
+      }
+      else {
+         fputs("\\ufffd",fid);                                                   //  invalid byte
+         pp++;
+      }
+   }
+
+   putc_unlocked('"',fid);
+   return;
+}
+
 //  build and initiate search dialog
 
 /***
@@ -270,7 +1344,11 @@ void m_quit()
          |                                                                 |
          |   [_] ignore file case     Ignore matching records with:        |
          |   [_] ignore string case    (o) any ignore string               |
-         |                             (o) all ignore strings              |
+         |   [_] UTF-8 text            (o) all ignore strings              |
+         |   [_] each file once (links)                                    |
+         |   [_] use .gitignore files                                      |
+         |   [x] search compressed files                                   |
+         |   [_] search archives (tar, zip)                                |
          |                                                                 |
          |           search path  [______________________________________] |
          |        search file(s)  [______________________________________] |
@@ -282,7 +1360,7 @@ void m_quit()
          |    date from  [_______]   to [_______]  -days or yyyy-mm-dd     |
          |                                                                 |
          |    [x] list matching records    with [__|-+] preceding records  |
-         |                                 with [__|-+] following records  |
+         |    [_] search statistics        with [__|-+] following records  |
          |                                                                 |
          |    search criteria: [load file] [save file]                     |
          |                                                                 |
@@ -314,6 +1392,11 @@ void m_search()
    zdialog_add_widget(zd,"label","space","vbr1");
    zdialog_add_widget(zd,"check","FignorecaseF","vbr1","ignore file case");
    zdialog_add_widget(zd,"check","FignorecaseS","vbr1","ignore string case");
+   zdialog_add_widget(zd,"check","Futf8","vbr1","UTF-8 text");                   //  2.8
+   zdialog_add_widget(zd,"check","Funique","vbr1","each file once (links)");
+   zdialog_add_widget(zd,"check","Fgitignore","vbr1","use .gitignore files");
+   zdialog_add_widget(zd,"check","Funpack","vbr1","search compressed files");
+   zdialog_add_widget(zd,"check","Farchive","vbr1","search archives (tar, zip)");
 
    zdialog_add_widget(zd,"hbox","space","hbr1",0,"space=15");
    zdialog_add_widget(zd,"vbox","vbr2","hbr1");
@@ -356,15 +1439,16 @@ void m_search()
    zdialog_add_widget(zd,"vbox","vblmr2","hblmr");
 
    zdialog_add_widget(zd,"check","list match","vblmr1","list matching records","space=2");
+   zdialog_add_widget(zd,"check","stats","vblmr1","search statistics","space=2");       //  2.8
 
    zdialog_add_widget(zd,"hbox","hbt1","vblmr2");
    zdialog_add_widget(zd,"label","lab_lm1","hbt1","with","space=3");
-   zdialog_add_widget(zd,"spin","prec","hbt1","0|99|1|0","space=3");
+   zdialog_add_widget(zd,"spin","prec","hbt1","0|9999|1|0","space=3");
    zdialog_add_widget(zd,"label","lab_lm2","hbt1","preceding records");
 
    zdialog_add_widget(zd,"hbox","hbt2","vblmr2");
    zdialog_add_widget(zd,"label","lab_lm3","hbt2","with","space=3");
-   zdialog_add_widget(zd,"spin","foll","hbt2","0|99|1|0","space=3");
+   zdialog_add_widget(zd,"spin","foll","hbt2","0|9999|1|0","space=3");
    zdialog_add_widget(zd,"label","lab_lm4","hbt2","following records");
 
    zdialog_add_widget(zd,"hbox","hbf","dialog",0,"space=3");
@@ -437,17 +1521,14 @@ void break_criteria(char *string, char *strings[Smax], int &count)
    count = 0;
    if (! strlen(string)) return;
 
-   for (ii = 0; ii < Smax; ii++)
-   {
-      if (strings[ii]) zfree(strings[ii]);
-      strings[ii] = 0;
-   }
+   for (ii = 0; ii < Smax; ii++)                                                 //  prior strings are released
+      strings[ii] = 0;                                                           //    with search arena              2.8
 
    for (ii = 0; ii < Smax; ii++)
    {
       pp = strtok(string," ");                                                   //  replace strField                   2.7
       if (! pp) break;                                                           //  (" chars. are retained)
-      strings[ii] = zstrdup(pp);
+      strings[ii] = Zarena_strdup(&Sarena,pp);
       string = 0;
    }
 
@@ -473,6 +1554,11 @@ int search_dialog_stuff(zdialog *zd)
    zdialog_stuff(zd,ruleIx,1);
    zdialog_stuff(zd,"FignorecaseF",int(FignorecaseF));                                //  1.8
    zdialog_stuff(zd,"FignorecaseS",int(FignorecaseS));                                //  1.7
+   zdialog_stuff(zd,"Futf8",int(Futf8));                                         //  2.8
+   zdialog_stuff(zd,"Funique",int(Funique));
+   zdialog_stuff(zd,"Fgitignore",int(Fgitignore));
+   zdialog_stuff(zd,"Funpack",int(Funpack));
+   zdialog_stuff(zd,"Farchive",int(Farchive));
    zdialog_stuff(zd,"sr_path",sr_path);
    zdialog_stuff(zd,"sr_file",sr_file);
    zdialog_stuff(zd,"sr_string",sr_string);
@@ -506,6 +1592,11 @@ int search_dialog_fetch(zdialog *zd)
 
    zdialog_fetch(zd,"FignorecaseF",FignorecaseF);                                //  1.8
    zdialog_fetch(zd,"FignorecaseS",FignorecaseS);                                //  1.7
+   zdialog_fetch(zd,"Futf8",Futf8);                                              //  2.8
+   zdialog_fetch(zd,"Funique",Funique);
+   zdialog_fetch(zd,"Fgitignore",Fgitignore);
+   zdialog_fetch(zd,"Funpack",Funpack);
+   zdialog_fetch(zd,"Farchive",Farchive);
 
    zdialog_fetch(zd,"sr_path",sr_path,Tmax);                                     //  get string entry fields
    zdialog_fetch(zd,"sr_file",sr_file,Tmax);
@@ -519,6 +1610,7 @@ int search_dialog_fetch(zdialog *zd)
    zdialog_fetch(zd,"list match",listmatch);                                     //  list matching records, yes/no
    zdialog_fetch(zd,"prec",listprec);                                            //  with preceding
    zdialog_fetch(zd,"foll",listfoll);                                            //  with following                     2.1
+   zdialog_fetch(zd,"stats",Fstats);                                             //  search statistics report           2.8
 
    dt_from = search_dialog_fetchdate(date_from);                                 //  get binary date range
    dt_to = search_dialog_fetchdate(date_to);
@@ -567,70 +1659,86 @@ time_t search_dialog_fetchdate(cchar *date)
 
 /**
  * @brief filescan - directory scan / file search function
+ * @return count of files found, -1 if the search criteria are not usable
  */
-void filescan()
+int filescan()
 {
-   int         ccp, ccf, ii, jj;
-   int         fcount, lcount, ftf, err;
-   char        ch;
-   cchar       *pfile, *pname;
+   int         ccp, ccf, ii, jj, acc;
+   int         fcount, lcount, err, indexed = 0, nhits = 0;
+   double      time0 = 0, time1 = 0, cpu0 = 0;
+   int64       alloc0[6];
+   int         done = 1;
+   int64       linepos = 0;
+   checkpoint  ck, ckin;
+   FILE        *fidck = 0;
+   char        fold[Tmax];
+   cchar       *pfile, *pname, *pp;
    struct tm   dfrom, dto;
    STATB       statf;
    FILE        *fid = null, *fid2;
+   filewalk    walk;
 
    killsearch = 0;
-
-   for (ii = 0; ii < (int) strlen(sr_string); ii++)
-   {
-      ch = sr_string[ii];
-      if (ch != ' ' && ch != '*' && strchr(delims,ch)) {
-         zmessageACK(mWin,"delimiter  %c  is contained in search string",ch);
-         return;
-      }
-   }
-
-   for (ii = 0; ii < (int) strlen(ig_string); ii++)
-   {
-      ch = ig_string[ii];
-      if (ch != ' ' && ch != '*' && strchr(delims,ch)) {
-         zmessageACK(mWin,"delimiter  %c  is contained in ignore string",ch);
-         return;
-      }
-   }
-
-   textwidget_append(mLog,0,"\n""begin search --------------------------- \n");  //  report all criteria used for search
-
-   if (Fhits) textwidget_append(mLog,0," search hits (files from previous search results) \n");
-   textwidget_append(mLog,0,"    find files with: %s \n",mstext[matchrule-1]);
-   if (ignorerule < 4) textwidget_append(mLog,0,"  ignore files with: %s \n",igtext[ignorerule-1]);
-   else textwidget_append(mLog,0,"  ignore match recs: %s \n",igtext[ignorerule-1]);
-
-   textwidget_append(mLog,0,"        search path: %s \n",sr_path);
-   textwidget_append(mLog,0,"        search file: %s \n",sr_file);
-   textwidget_append(mLog,0,"   search string(s): %s \n",sr_string);
-   textwidget_append(mLog,0,"     ignore file(s): %s \n",ig_file);
-   textwidget_append(mLog,0,"   ignore string(s): %s \n",ig_string);
-   textwidget_append(mLog,0,"  string delimiters: %s \n",delims);
+   Flimit = 0;                                                                   //  2.8
+   Tdeadline = (deadline > 0) ? get_seconds() + deadline : 0;
+   memset(&ck,0,sizeof(checkpoint));                                             //  checkpoint of this search
+   memcpy(ck.magic,checkmagic,8);
+   ck.hash = criteria_hash();                                                    //  (before break_criteria())
+   ck.hits = Fhits;
+   Tcheckpoint = 0;
+   if (Fbatch && checksecs > 0) Tcheckpoint = get_seconds() + checksecs;
+
+   delims_init();                                                                //  2.8
+   if (delim_check(sr_string,"search")) return -1;
+   if (delim_check(ig_string,"ignore")) return -1;
+
+   log_append(0,"\n""begin search --------------------------- \n");              //  report all criteria used for search
+
+   if (Fhits) log_append(0," search hits (files from previous search results) \n");
+   log_append(0,"    find files with: %s \n",mstext[matchrule-1]);
+   if (ignorerule < 4) log_append(0,"  ignore files with: %s \n",igtext[ignorerule-1]);
+   else log_append(0,"  ignore match recs: %s \n",igtext[ignorerule-1]);
+
+   log_append(0,"        search path: %s \n",sr_path);
+   log_append(0,"        search file: %s \n",sr_file);
+   log_append(0,"   search string(s): %s \n",sr_string);
+   log_append(0,"     ignore file(s): %s \n",ig_file);
+   log_append(0,"   ignore string(s): %s \n",ig_string);
+   log_append(0,"  string delimiters: %s \n",delims);
 
    if(FignorecaseF){                                                             //  1.8
-      textwidget_append(mLog,0," ignore file case: YES \n");
+      log_append(0," ignore file case: YES \n");
    }else{
-      textwidget_append(mLog,0," ignore file case: NO \n");
+      log_append(0," ignore file case: NO \n");
    }
    if(FignorecaseS){                                                             //  1.7
-      textwidget_append(mLog,0," ignore string case: YES \n");
+      log_append(0," ignore string case: YES \n");
    }else{
-      textwidget_append(mLog,0," ignore string case: NO \n");
+      log_append(0," ignore string case: NO \n");
    }
+   if (Futf8) log_append(0," UTF-8 text: YES \n");                              //  2.8
+   if (Funique) log_append(0," each file once: YES \n");
+   if (Fgitignore) log_append(0," use .gitignore files: YES \n");
+   if (! Funpack) log_append(0," search compressed files: NO \n");
+   if (Farchive) log_append(0," search archives: YES \n");
+   if (walkorder) log_append(0," folder order: %s \n",ordernames[walkorder/walk_bfs]);
    if (dt_from || dt_to) {                                                       //  report date range if defined
       dfrom = *localtime(&dt_from);
       dto = *localtime(&dt_to);
-      textwidget_append(mLog,0,"     mod date from: %d-%02d-%02d  to: %d-%02d-%02d \n",
+      log_append(0,"     mod date from: %d-%02d-%02d  to: %d-%02d-%02d \n",
                      dfrom.tm_year+1900, dfrom.tm_mon+1, dfrom.tm_mday,
                      dto.tm_year+1900, dto.tm_mon+1, dto.tm_mday);
    }
 
-   textwidget_append2(mLog,0,"\n");                                              //  scroll to end
+   log_append2(0,"\n");                                                          //  scroll to end
+
+   memset(&stats,0,sizeof(stats));                                               //  reset search statistics            2.8
+   fstune_open(sr_path);                                                         //  concurrency for its file system
+   if (Fstats) {
+      start_timer(stats.Twall);
+      cpu0 = CPUtime2();
+      zmalloc_counts(alloc0);
+   }
 
    ccp = strlen(sr_path);
    ccf = strlen(sr_file);
@@ -643,446 +1751,4004 @@ void filescan()
    if (dt_from > dt_to) goto search_exit;
    if (dt_from > time(0)) goto search_exit;
 
+   Zarena_reset(&Sarena);                                                        //  free prior search criteria         2.8
    break_criteria(sr_file,srfiles,nsrf);                                         //  break search criteria into
    break_criteria(sr_string,srstrings,nsrs);                                     //    search/ignore substrings
    break_criteria(ig_file,igfiles,nigf);
    break_criteria(ig_string,igstrings,nigs);
 
+   if (FignorecaseS && ! Futf8) {                                                //  ignore string case:                2.8
+      for (ii = 0; ii < nsrs; ii++) strToLower(srstrings[ii]);                   //    fold search and ignore strings
+      for (ii = 0; ii < nigs; ii++) strToLower(igstrings[ii]);                   //      once, fold records in recsearch()
+   }
+
+   if (FignorecaseS && Futf8) {                                                  //  same, Unicode case folding
+      for (ii = 0; ii < nsrs; ii++) {                                            //  (folded cc <= original cc)
+         utf8_fold(fold,srstrings[ii],Tmax);
+         strcpy(srstrings[ii],fold);
+      }
+      for (ii = 0; ii < nigs; ii++) {
+         utf8_fold(fold,igstrings[ii],Tmax);
+         strcpy(igstrings[ii],fold);
+      }
+   }
+
+   Fmemo = 0;                                                                    //  use token match cache if matching  2.8
+   for (ii = 0; ii < nsrs + nigs; ii++) {                                        //    costs more than a cache lookup:
+      pp = strchr((ii < nsrs) ? srstrings[ii] : igstrings[ii-nsrs],'*');         //      string with inner '*' 4,
+      Fmemo += (pp && pp[1]) ? 4 : 1;                                            //        literal or prefix* 1
+   }
+   Fmemo = (Fmemo >= memocost);
+
+   literal_init();                                                               //  literal scan or tokenize all       2.8
+   order_init();                                                                 //  order strings by selectivity
+
+   Tfiledeadline = 0;                                                            //  first file is always searched,
+                                                                                 //    a continued search makes progress
+   if (Fcontinue) {                                                              //  continue stopped search            2.8
+      err = checkpoint_load(ckin,fidck);
+      if (err || ckin.hash != ck.hash || ckin.hits != ck.hits) {
+         if (fidck) fclose(fidck);
+         log_error("no stopped search with these criteria");
+         return -1;
+      }
+      err = truncate(hitsFile,ckin.hitscc);                                      //  hits found before the checkpoint
+      if (err) {
+         fclose(fidck);
+         log_error("cannot truncate %s: %s",hitsFile,strerror(errno));
+         return -1;
+      }
+      log_append(0," continue stopped search \n");
+   }
+
    if (! Fhits)                                                                  //  normal search
    {
-      fid = fopen(hitsFile,"w");                                                 //  open output file for search hits
+      fid = fopen(hitsFile,Fcontinue ? "a" : "w");                               //  open output file for search hits
       if (! fid) zappcrash("cannot open search_hits output file");
 
-      for (ii = 0; ii < nsrf; ii++)                                              //  loop all search files
+      if (Findex && ! Fcontinue) {                                               //  search with token index            2.8
+         jj = index_search(fid);
+         if (jj >= 0) {
+            fcount = jj;
+            indexed = 1;
+         }
+      }
+
+      for (ii = Fcontinue ? ckin.sfile : 0; ii < nsrf && ! indexed; ii++)        //  loop all search files
       {
          strcpy(workbuff,sr_path);                                               //  combine pathname/filename to search
          if (sr_path[ccp-1] == '*' && srfiles[ii][0] == '*')
                strcat(workbuff,srfiles[ii]+1);                                   //  avoid path/**file
          else  strcat(workbuff,srfiles[ii]);
 
-         ftf = 1;                                                                //  new file search
+         walk_open(walk,workbuff,(FignorecaseF ? walk_nocase : 0) |              //  new file search                    2.8
+                                 (Funique ? walk_unique : 0) |
+                                 (Fgitignore ? walk_gitignore : 0) |
+                                 (Farchive ? walk_archive : 0) |
+                                 (Fbatch ? walk_track : 0) | walkorder);
+         walk.prune = igfiles;                                                   //  skip folders of ignored files
+         walk.nprune = nigf;
+
+         if (fidck && ii == ckin.sfile) {                                        //  continue walk from checkpoint      2.8
+            err = walk_restore(walk,fidck);
+            fclose(fidck);
+            fidck = 0;
+            if (err) {
+               log_error("damaged checkpoint file: %s",checkpointFile);
+               walk_close(walk);
+               fclose(fid);
+               return -1;
+            }
+         }
+
+         ck.sfile = ii;
+         done = 1;
 
          while (true)
          {
-            if (FignorecaseF) {                                                  //  find matching files, ignoring case
-               pfile = SearchWildCase(workbuff,ftf);                             //  1.8
-               if (! pfile) break;
+            if (Tcheckpoint && get_seconds() > Tcheckpoint) {                    //  periodic checkpoint                2.8
+               fflush(fid);
+               ck.hitscc = ftell(fid);
+               checkpoint_save(ck,&walk,1);
+               Tcheckpoint = get_seconds() + checksecs;
             }
-            else {
-               pfile = SearchWild(workbuff,ftf);                                 //  find matching files, case match
-               if (! pfile) break;
+
+            if (search_limit(fcount,nhits)) break;                               //  stop at search limit               2.8
+
+            if (Fstats) time1 = get_seconds();                                   //  2.8
+
+            pfile = walk_next(walk);                                             //  find matching files
+            if (! pfile) break;
+
+            if (Fstats) {                                                        //  traversal time
+               time0 = get_seconds();
+               stats.Twalk += time0 - time1;
+               stats.Nwalk++;
             }
 
             pname = strrchr(pfile,'/') + 1;                                      //  file name part
-            stbar_message(stbar,pfile);                                          //  progress tracking in status bar
+            if (! Fbatch) stbar_message(stbar,pfile);                            //  progress tracking in status bar
 
             for (jj = 0; jj < nigf; jj++)
             {
                if (MatchWild(igfiles[jj],pname) == 0) break;                     //  file name part matches ignore file
                if (MatchWild(igfiles[jj],pfile) == 0) break;                     //  whole filespec matches ignore file
             }
+
+            if (Fstats) {                                                        //  name filter time
+               time1 = get_seconds();
+               stats.Tname += time1 - time0;
+               if (jj < nigf) stats.Xname++;
+            }
+
             if (jj < nigf) continue;                                             //  ignore file
 
             if (dt_to > 0) {                                                     //  check mod date against range
-               err = stat(pfile,&statf);
+               if (walk.arc) {                                                   //  archive member date
+                  statf.st_mtime = walk.arc->mtime;
+                  err = 0;
+               }
+               else err = stat(pfile,&statf);
+               if (Fstats) {
+                  stats.Tstat += get_seconds() - time1;                          //  stat/date filter time
+                  if (err) stats.Xstat++;
+                  else if (statf.st_mtime < dt_from ||
+                           statf.st_mtime > dt_to) stats.Xdate++;
+               }
                if (err) continue;
                if (statf.st_mtime < dt_from ||                                   //  out of range, ignore file
                    statf.st_mtime > dt_to) continue;
             }
 
+            if (Flatency) time0 = get_seconds();
             lcount = filesearch(pfile);                                          //  search for match strings, list hits
+            if (Flatency) latency_add(get_seconds() - time0);                    //  per-file latency for benchmark    2.8
+            done = ! Fstopped;
+            if (! done) break;                                                   //  stopped inside the file
+            Tfiledeadline = Tdeadline;
             if (lcount) {
+               if (Fstats) time0 = get_seconds();
                fprintf(fid,"%s""\n",pfile);                                      //  write matching file to hits list
+               if (Fstats) stats.Tout += get_seconds() - time0;
+               if (Fhittime) hit_add();                                          //  time found, for benchmark         2.8
                fcount++;
+               nhits += lcount;
             }
 
-            if (killsearch) {
-               ftf = 2;                                                          //  terminate search
-               if (FignorecaseF)                                                 //  1.8
-                  SearchWildCase(workbuff,ftf);
-               else
-                  SearchWild(workbuff,ftf);
-               break;
-            }
+            if (killsearch) break;                                               //  terminate search
 
             zmainloop();                                                         //  keep GUI alive
          }
 
-         if (killsearch) break;
+         stats.Ndirs += walk.Ndirs;                                              //  walker counts                      2.8
+         stats.Nentries += walk.Nentries;
+         stats.Nwstat += walk.Nstat;
+         stats.Xdup += walk.Xdup;
+         stats.Xloop += walk.Xloop;
+         stats.Nigfiles += walk.Nigfiles;
+         stats.Xprune += walk.Xprune;
+         stats.Xigfile += walk.Xigfile;
+         stats.Narc += walk.Narc;
+         stats.Nmember += walk.Nmember;
+         stats.Xarc += walk.Xarc;
+
+         if (Fbatch && (killsearch || Flimit)) {                                 //  save where the search stopped      2.8
+            fflush(fid);
+            ck.hitscc = ftell(fid);
+            checkpoint_save(ck,&walk,done);
+         }
+
+         walk_close(walk);
+
+         if (killsearch || Flimit) break;
       }
 
       fclose(fid);
+      if (fidck) fclose(fidck);                                                  //  (search file not found)
+      fidck = 0;
    }
 
    if (Fhits)                                                                    //  search hits (previous files found)
    {
       strcpy(hitsFile2,hitsFile);                                                //  make copy of previous hits file
       strcat(hitsFile2,"_2");
-      err = Qshell(0,0,"mv -f %s %s",hitsFile,hitsFile2);
-      if (err) {
-         zmessageACK(mWin,"no previous files to search");
-         return;
+      if (! Fcontinue) {                                                         //  (continue: copy made before)
+         err = Qshell(0,0,"mv -f %s %s",hitsFile,hitsFile2);
+         if (err) {
+            log_error("no previous files to search");
+            return -1;
+         }
       }
 
       fid2 = fopen(hitsFile2,"r");                                               //  open copy for reading previous hits
       if (! fid2) zappcrash("cannot open search_hits input file");
+      if (Fcontinue) fseek(fid2,ckin.hitspos,SEEK_SET);                          //  previous hits not yet searched
 
-      fid = fopen(hitsFile,"w");                                                 //  open hits for output of new hits
+      fid = fopen(hitsFile,Fcontinue ? "a" : "w");                               //  open hits for output of new hits
       if (! fid) zappcrash("cannot open search_hits output file");
 
       while (true)
       {
+         if (Tcheckpoint && get_seconds() > Tcheckpoint) {                       //  periodic checkpoint                2.8
+            fflush(fid);
+            ck.hitscc = ftell(fid);
+            ck.hitspos = ftell(fid2);
+            checkpoint_save(ck,0,1);
+            Tcheckpoint = get_seconds() + checksecs;
+         }
+
+         if (search_limit(fcount,nhits)) break;                                  //  stop at search limit               2.8
+
+         if (Fstats) time1 = get_seconds();                                      //  2.8
+
+         linepos = ftell(fid2);
          pfile = fgets_trim(workbuff,999,fid2);                                  //  get next file from hit list
          if (! pfile) break;
 
+         if (Fstats) {                                                           //  traversal time
+            time0 = get_seconds();
+            stats.Twalk += time0 - time1;
+            stats.Nwalk++;
+         }
+
          pname = strrchr(pfile,'/') + 1;                                         //  file name part
-         stbar_message(stbar,pfile);                                             //  progress tracking in status bar
+         if (! Fbatch) stbar_message(stbar,pfile);                               //  progress tracking in status bar
 
          for (ii = 0; ii < nsrf; ii++)                                           //  check for match with search files
             if (MatchWild(srfiles[ii],pname) == 0) break;                        //  (match file name only)
-         if (ii == nsrf) continue;                                               //  no match
 
-         for (jj = 0; jj < nigf; jj++)
+         for (jj = 0; ii < nsrf && jj < nigf; jj++)
          {
             if (MatchWild(igfiles[jj],pname) == 0) break;                        //  file name part matches ignore file
             if (MatchWild(igfiles[jj],pfile) == 0) break;                        //  whole filespec matches ignore file
          }
+
+         if (Fstats) {                                                           //  name filter time
+            time1 = get_seconds();
+            stats.Tname += time1 - time0;
+            if (ii == nsrf || jj < nigf) stats.Xname++;
+         }
+
+         if (ii == nsrf) continue;                                               //  no match
          if (jj < nigf) continue;                                                //  ignore file
 
          if (dt_to > 0) {                                                        //  check mod date against range
-            err = stat(pfile,&statf);
+            acc = arc_split(pfile);
+            if (acc) {                                                           //  archive member: archive date
+               strncpy0(workbuff2,pfile,acc+1);
+               err = stat(workbuff2,&statf);
+            }
+            else err = stat(pfile,&statf);
+            if (Fstats) {
+               stats.Tstat += get_seconds() - time1;                             //  stat/date filter time
+               if (err) stats.Xstat++;
+               else if (statf.st_mtime < dt_from ||
+                        statf.st_mtime > dt_to) stats.Xdate++;
+            }
             if (err) continue;
             if (statf.st_mtime < dt_from ||                                      //  out of range, ignore file
                 statf.st_mtime > dt_to) continue;
          }
 
+         if (Flatency) time0 = get_seconds();
          lcount = filesearch(pfile);                                             //  search for match strings, list hits
+         if (Flatency) latency_add(get_seconds() - time0);                       //  per-file latency for benchmark    2.8
+         done = ! Fstopped;
+         if (! done) break;                                                      //  stopped inside the file
+         Tfiledeadline = Tdeadline;
          if (lcount) {
+            if (Fstats) time0 = get_seconds();
             fprintf(fid,"%s""\n",pfile);                                         //  write matching file to hits list
+            if (Fstats) stats.Tout += get_seconds() - time0;
+            if (Fhittime) hit_add();                                             //  time found, for benchmark         2.8
             fcount++;
+            nhits += lcount;
          }
 
          if (killsearch) break;
          zmainloop();                                                            //  keep GUI alive
       }
 
+      if (Fbatch && (killsearch || Flimit)) {                                    //  save where the search stopped      2.8
+         fflush(fid);
+         ck.hitscc = ftell(fid);
+         ck.hitspos = done ? ftell(fid2) : linepos;
+         checkpoint_save(ck,0,done);
+      }
+
       fclose(fid);
       fclose(fid2);
    }
 
+   if (Fbatch && ! killsearch && ! Flimit)                                       //  completed, none to continue        2.8
+      remove(checkpointFile);
+
 search_exit:
    if (killsearch) {
-      textwidget_append2(mLog,0," *** search killed *** \n");
-      killsearch = 0;
+      log_append2(0," *** search killed *** \n");
+      if (Fbatch) log_append(0," continue the search with --continue \n");       //  2.8
    }
    else {
-      textwidget_append(mLog,0,"\n %d files found \n",fcount);
-      textwidget_append2(mLog,0,"search completed ----------------------- \n");
+      if (Flimit) {                                                              //  2.8
+         log_append(0,"\n *** search stopped: %s, the results are partial *** \n",
+                        limittext[Flimit-1]);
+         log_append(0," continue the search with --continue \n");
+      }
+      log_append(0,"\n %d files found \n",fcount);
+      if (Fstats) {                                                              //  2.8
+         stats.Twall = get_timer(stats.Twall);
+         stats.Tcpu = CPUtime2() - cpu0;
+         zmalloc_counts(stats.Nalloc);                                           //  allocations by this search,
+         for (ii = 0; ii < 6; ii++)                                              //    bytes in use at the end
+            if (ii != 4) stats.Nalloc[ii] -= alloc0[ii];
+         if (Fstats == 1) stats_report();                                        //  add statistics report
+      }
+      log_append2(0,"search completed ----------------------- \n");
    }
 
-   return;
+   if (Fbatch && outformat != out_text) out_end(fcount);                         //  2.8
+   killsearch = 0;
+   return fcount;
 }
 
 
-//  file search function - search all file records for search and ignore string(s)
-
-int filesearch(cchar *filename)
+/**
+ * @brief search_limit - test the search limits from the command line
+ *        (--max-files, --max-hits, --deadline) before the next file,
+ *        the deadline after the first file searched (Tfiledeadline)
+ * @param fcount     files found
+ * @param nhits      matches found (sum of file match counts)
+ * @return limit_xxx if the search must stop, also set in Flimit
+ */
+int search_limit(int fcount, int64 nhits)                                        //  2.8
 {
-   void recsearch(char *buff,                                                    //  record to search                   1.5
-                  int Rmatch[], int nsrs,                                        //  search strings matched
-                  int Rignore[], int nigs,                                       //  ignore strings matched
-                  int &recmatch, int &recignore);                                //  returned total counts
+   if (maxfiles && fcount >= maxfiles) Flimit = limit_files;
+   else if (maxhits && nhits >= maxhits) Flimit = limit_hits;
+   else if (Tfiledeadline && get_seconds() > Tfiledeadline) Flimit = limit_deadline;
+   return Flimit;
+}
 
-   char * recsearch1(char* const record,                                         //  record to search                   2.5
-                     char* const wildstr,                                        //  wildcard string to search for
-                     char* const delims,                                         //  string delimiters in record
-                     int &cc,                                                    //  length of returned match string
-                     bool ignorecase);                                           //  ignore case flag
 
-   int      Fmatch[Smax], Fignore[Smax];                                         //  search and ignore strings in file
-   int      Rmatch[Smax], Rignore[Smax];                                         //  search and ignore strings in record
-   int      filematch, recmatch, recignore;
-   char     buff[1000], *pp, *pbuff[100];
-   int      ii, Nline, Nlistfoll = 0, Fclearprec = 0;
-   int      line, cc, pos;
-   FILE     *fid;
+/**
+ * @brief criteria_hash - hash of the search criteria and options that change
+ *        the files found, to check that a stopped search continues the same
+ */
+uint64 criteria_hash()                                                           //  2.8
+{
+   char     buff[6*Tmax+200];
+   int      cc;
+
+   cc = snprintf(buff,sizeof(buff),"%d %d|%s|%s|%s|%s|%s|%s|%ld %ld|%d %d %d %d %d %d %d %d",
+                  matchrule, ignorerule, sr_path, sr_file, sr_string, ig_file, ig_string,
+                  delims, long(dt_from), long(dt_to), FignorecaseF, FignorecaseS, Futf8,
+                  Funique, Fgitignore, Funpack, Farchive, walkorder);
+   if (cc >= int(sizeof(buff))) cc = sizeof(buff) - 1;
+   return zhash64(buff,cc);
+}
 
-   if (nsrs == 0 && nigs == 0) {                                                 //  no search or ignore strings (matches)
-      textwidget_append2(mLog,0," %s \n",filename);                              //  output file name with no record counts
-      return 1;
-   }
 
-   fid = fopen(filename,"r");                                                    //  open file
-   if (! fid) return 0;
+//  checkpoint file of a stopped search, under get_zhomedir()
+//  layout:  checkpoint, then walk_save() data if the search walks files
+//  The hits found before the checkpoint are the search_hits file up to
+//  hitscc. The file is written as .new and renamed, so a crash while
+//  writing leaves the prior checkpoint.
 
-   for (ii = 0; ii < Smax; ii++) Fmatch[ii] = Fignore[ii] = 0;                   //  no strings found in file yet
-   filematch = 0;
+namespace ckpt_names
+{
+   int   Ferr;                                                                   //  short read or write
 
-   while (true)
-   {
-      pp = fgets_trim(buff,999,fid,1);                                           //  read next record
-      if (! pp) break;
-      if (killsearch) break;
+   void putcc(FILE *fid, const void *data, int cc);
+   void putstr(FILE *fid, cchar *string);
+   void getcc(FILE *fid, void *data, int cc);
+   char * getstr(FILE *fid, char *string, int maxcc);
+}
 
-      recsearch(buff,Rmatch,nsrs,Rignore,nigs,recmatch,recignore);               //  search for match and ignore strings
 
-      if (recmatch + recignore == 0) continue;                                   //  record has no matches, ignore
+void ckpt_names::putcc(FILE *fid, const void *data, int cc)                      //  2.8
+{
+   if (fwrite(data,1,cc,fid) != size_t(cc)) Ferr = 1;
+   return;
+}
 
-      if (nigs > 0) {
-         if (ignorerule == ignore_any && recignore > 0) {
-            filematch = 0;                                                       //  reject if any ignore string in record
-            break;
-         }
 
-         if (ignorerule == ignore_rec_all && recignore == nigs) {
-            filematch = 0;                                                       //  reject if all ignore strings in record
-            break;
-         }
-      }
+void ckpt_names::putstr(FILE *fid, cchar *string)                                //  length, string
+{
+   int      cc = strlen(string);
+   putcc(fid,&cc,sizeof(int));
+   putcc(fid,string,cc);
+   return;
+}
 
-      if (recmatch > 0) {
-         if (matchrule == match_rec_all && recmatch < nsrs) recmatch = 0;        //  ignore record without all match strings
-         if (recignore > 0) {
-            if (ignorerule == ignore_match_any) recmatch = 0;                    //  ignore record with any ignore string
-            if (ignorerule == ignore_match_all)
-                if (recignore == nigs) recmatch = 0;                             //  ignore record with all ignore strings
-         }
-      }
 
-      if (recmatch > 0) {
-         filematch += recmatch;                                                  //  find matches for entire file
-         for (ii = 0; ii < nsrs; ii++) Fmatch[ii] += Rmatch[ii];
-      }
+void ckpt_names::getcc(FILE *fid, void *data, int cc)                            //  2.8
+{
+   if (Ferr || fread(data,1,cc,fid) != size_t(cc)) {
+      memset(data,0,cc);
+      Ferr = 1;
+   }
+   return;
+}
 
-      if (recignore > 0)                                                         //  ignore matches for entire file
-         for (ii = 0; ii < nigs; ii++) Fignore[ii] += Rignore[ii];
+
+char * ckpt_names::getstr(FILE *fid, char *string, int maxcc)                    //  string from putstr()
+{
+   int      cc = 0;
+   getcc(fid,&cc,sizeof(int));
+   if (cc < 0 || cc >= maxcc) { Ferr = 1; cc = 0; }
+   getcc(fid,string,cc);
+   string[cc] = 0;
+   return string;
+}
+
+
+/**
+ * @brief checkpoint_save - save where a search is, in checkpointFile
+ * @param ck      criteria hash, search file, hits file positions
+ * @param fw      walker to save, or null (search of prior hits)
+ * @param done    the last file from the walker was searched
+ * @return 0 if OK, else errno
+ */
+int checkpoint_save(checkpoint &ck, filewalk *fw, int done)                      //  2.8
+{
+   using namespace ckpt_names;
+   char     tfile[1010];
+   FILE     *fid;
+
+   snprintf(tfile,1010,"%s.new",checkpointFile);
+   fid = fopen(tfile,"w");
+   if (! fid) return errno;
+   Ferr = 0;
+   putcc(fid,&ck,sizeof(checkpoint));
+   if (fw) walk_save(*fw,fid,done);
+   if (fclose(fid) || Ferr || rename(tfile,checkpointFile)) {
+      log_error("%s: %s",checkpointFile,Ferr ? "write error" : strerror(errno));
+      remove(tfile);
+      return EIO;
    }
+   return 0;
+}
 
-   fclose(fid);
 
-   if (killsearch) return 0;
+/**
+ * @brief checkpoint_load - read the checkpoint of a stopped search
+ * @param ck      checkpoint read
+ * @param fid     open checkpointFile, positioned for walk_restore()
+ * @return 0 if OK, else errno
+ */
+int checkpoint_load(checkpoint &ck, FILE *&fid)                                  //  2.8
+{
+   using namespace ckpt_names;
+
+   memset(&ck,0,sizeof(checkpoint));
+   fid = fopen(checkpointFile,"r");
+   if (! fid) return errno;
+   Ferr = 0;
+   getcc(fid,&ck,sizeof(checkpoint));
+   if (Ferr || memcmp(ck.magic,checkmagic,8)) return EINVAL;
+   return 0;
+}
 
-   if (filematch == 0) return 0;                                                 //  reject file with no match strings
 
-   if (ignorerule == ignore_all && nigs > 0) {
-      for (ii = 0; ii < nigs; ii++) if (Fignore[ii] == 0) break;                 //  reject files with all ignore strings
-      if (ii == nigs) return 0;
+//  (dev, ino) set for the file walker. The set is split into shards with
+//  their own lock, so that concurrent walkers seldom wait for each other.
+//  The key is the inode number and the device number folded to 32 bits
+//  (Linux device numbers fit), 12 bytes, kept inside the hash table entry.
+
+void inodeset_open(inodeset &set)                                                //  2.8
+{
+   for (int ii = 0; ii < inodeshards; ii++) {
+      pthread_mutex_init(&set.lock[ii],0);
+      set.table[ii] = new Zhash(256);
    }
+   return;
+}
 
-   if (matchrule == match_all) {
-      for (ii = 0; ii < nsrs; ii++) if (Fmatch[ii] == 0) return 0;               //  reject files without all match strings
+
+int inodeset_key(char key[12], dev_t dev, ino_t ino)                             //  2.8
+{
+   uint     dev32 = uint(dev ^ (uint64(dev) >> 32));
+   uint64   ino64 = ino;
+
+   memcpy(key,&ino64,8);
+   memcpy(key+8,&dev32,4);
+   return (ino64 ^ (ino64 >> 8) ^ dev32) & (inodeshards - 1);                    //  shard
+}
+
+
+int inodeset_add(inodeset &set, dev_t dev, ino_t ino)                            //  2.8
+{
+   char     key[12];
+   int      shard, added;
+
+   shard = inodeset_key(key,dev,ino);
+
+   pthread_mutex_lock(&set.lock[shard]);
+   set.table[shard]->Put(key,12,added);
+   pthread_mutex_unlock(&set.lock[shard]);
+   return added;
+}
+
+
+void inodeset_close(inodeset &set)                                               //  2.8
+{
+   for (int ii = 0; ii < inodeshards; ii++) {
+      pthread_mutex_destroy(&set.lock[ii]);
+      delete set.table[ii];
+      set.table[ii] = 0;
    }
+   return;
+}
 
-   if (! listmatch) {
-      textwidget_append2(mLog,0," %5d %s \n",filematch,filename);                //  output match count and file name
-      return filematch;
+
+//  file tree walker, replaces SearchWild() and the 'find -L' process it reads.
+//  Directories wait in a frontier stack and are read one at a time with
+//  readdir(). The entry type from readdir() avoids stat() except for symlinks,
+//  which are followed like 'find -L'. Each opened directory gets its (dev, ino)
+//  from fstat() and is skipped if it is one of its own parents (a symlink
+//  loop). With 'unique', each directory is read once and each file reported
+//  once, no matter how many symlinks or hard links lead to it.
+//  With 'gitignore', the .gitignore, .ignore and .findwildignore files of each
+//  folder are loaded when it is opened, and entries matching their rules are
+//  skipped: ignored folders are never opened. .git folders are skipped too.
+//  The walk starts at the wpath part before the first '*', as SearchWild().
+//  The frontier order is depth first (as 'find'), or with walk_bfs breadth
+//  first (a queue), with walk_recent the folder modified last first (a heap,
+//  needs a stat() per folder), or with walk_small depth first, with the files
+//  of each folder returned smallest first (a stat() per file), so that the
+//  first files are found sooner when large folders or files come first.
+
+void walk_open(filewalk &fw, cchar *wpath, int options)                          //  2.8
+{
+   char     root[XFCC], *pp;
+   walkdir  *dd;
+
+   memset(&fw,0,sizeof(filewalk));
+   fw.wpath = wpath;
+   fw.nocase = (options & walk_nocase) ? 1 : 0;
+   fw.unique = (options & walk_unique) ? 1 : 0;
+   fw.gitignore = (options & walk_gitignore) ? 1 : 0;
+   fw.archives = (options & walk_archive) ? 1 : 0;
+   fw.track = (options & walk_track) ? 1 : 0;
+   fw.order = options & walk_order;
+   Zarena_open(&fw.arena,65536);
+   if (fw.unique) {
+      inodeset_open(fw.dirs);
+      inodeset_open(fw.files);
    }
 
-   //  file is selected and detail is wanted, read again to list matching records
+   strncpy0(root,wpath,XFCC);
+   pp = strchr(root,'*');
+   if (pp) {                                                                     //  /aaa/bbb/cc*cc... >>> /aaa/bbb/
+      while ((*pp != '/') && (pp > root)) pp--;
+      if (pp > root) *(pp+1) = 0;
+   }
 
-   snprintf(buff,999,"\n %s \n",filename);                                       //  output file name in bold
-   textwidget_append2(mLog,1,buff);
+   fw.Mfront = 1000;
+   fw.frontier = (walkdir **) zmalloc(fw.Mfront * sizeof(walkdir *),0);
+   dd = (walkdir *) Zarena_alloc(&fw.arena,sizeof(walkdir));
+   dd->path = Zarena_strdup(&fw.arena,root);
+   dd->parent = 0;
+   dd->ignore = 0;
+   dd->mtime = 0;
+   walk_push(fw,dd);
+   return;
+}
 
-   fid = fopen(filename,"r");                                                    //  open file
-   if (! fid) return 0;
 
-   Nline = 0;                                                                    //  track line numbers                 2.0
+//  open the next directory from the frontier
+//  returns 0 if opened, 1 if the frontier is empty, 2 if the root is a file
 
-   for (ii = 0; ii <= listprec; ii++)                                            //  number preceding recs. to list     1.5
-      pbuff[ii] = 0;                                                             //  empty at first
+int walk_opendir(filewalk &fw)
+{
+   walkdir  *dd, *pd;
+   STATB    statb;
 
-   while (true)
+   while ((dd = walk_pop(fw)))
    {
-      if (killsearch) break;
+      fw.dir = opendir(dd->path);
+      if (! fw.dir) {
+         if (errno == ENOTDIR && ! dd->parent) {                                 //  root is a file
+            strncpy0(fw.file,dd->path,XFCC);
+            return 2;
+         }
+         continue;                                                               //  no access, gone
+      }
 
-      ii = listprec;                                                             //  discard oldest preceding record    1.5
-      if (pbuff[ii]) zfree(pbuff[ii]);
+      if (fstat(dirfd(fw.dir),&statb)) {                                         //  no access, gone
+         closedir(fw.dir);
+         fw.dir = 0;
+         continue;
+      }
 
-      for (ii = listprec; ii > 0; ii--)                                          //  save 'listprec' preceding records
-         pbuff[ii] = pbuff[ii-1];
+      dd->dev = statb.st_dev;
+      dd->ino = statb.st_ino;
+
+      for (pd = dd->parent; pd; pd = pd->parent)                                 //  symlink to own parent
+         if (pd->ino == dd->ino && pd->dev == dd->dev) break;
+
+      if (pd) fw.Xloop++;
+      else if (fw.unique && ! inodeset_add(fw.dirs,dd->dev,dd->ino))             //  read before, other path
+         fw.Xdup++;
+      else {
+         fw.curr = dd;
+         fw.Npush = fw.Nfront;
+         fw.Ndirs++;
+         if (fw.gitignore) dd->ignore = ignore_load(fw,dd,dirfd(fw.dir));        //  add this folder's ignore rules
+         return 0;
+      }
 
-      pbuff[0] = (char *) zmalloc(1000);                                         //  allocate new buffer
-      pp = fgets_trim(pbuff[0],999,fid,1);                                       //  read next record
-      if (! pp) break;
+      closedir(fw.dir);
+      fw.dir = 0;
+   }
 
-      Nline++;                                                                   //  track line numbers                 2.0
+   return 1;
+}
 
-      recsearch(pbuff[0],Rmatch,nsrs,Rignore,nigs,recmatch,recignore);           //  search for match and ignore strings
 
-      if (recmatch > 0) {
-         if (matchrule == match_rec_all && recmatch < nsrs) recmatch = 0;        //  ignore record without all match strings
-         if (recignore > 0) {
-            if (ignorerule == ignore_match_any) recmatch = 0;                    //  ignore record with any ignore string
-            if (ignorerule == ignore_match_all)
-                if (recignore == nigs) recmatch = 0;                             //  ignore record with all ignore strings
+//  walk_small: order of files, smaller first, else as read
+
+int walk_sizecomp(const void *f1, const void *f2)                                //  2.8
+{
+   const walkfile *wf1 = (const walkfile *) f1, *wf2 = (const walkfile *) f2;
+
+   if (wf1->size != wf2->size) return (wf1->size < wf2->size) ? -1 : 1;
+   return wf1->name - wf2->name;
+}
+
+
+cchar * walk_next(filewalk &fw)                                                  //  2.8
+{
+   struct dirent  *ent;
+   walkdir        *dd;
+   walkfile       *wf;
+   STATB          statb;
+   dev_t          dev;
+   ino_t          ino;
+   cchar          *name;
+   int            err, type, cc, ii, jj, ncc, atype, statd;
+
+   while (true)
+   {
+      if (fw.arc) {                                                              //  list archive members
+         name = arc_next(fw.arc);
+         if (! name) {                                                           //  archive done
+            if (fw.arc->error) fw.Xarc++;
+            arc_close(fw.arc);
+            fw.arc = 0;
+            continue;
          }
+         fw.arcdone++;
+         fw.Nmember++;
+         cc = fw.arccc;                                                          //  archive//member
+         ncc = strlen(name);
+         if (cc + ncc > XFCC-2) continue;
+         memcpy(fw.file+cc,name,ncc+1);
+         if (fw.nocase ? MatchWildIgnoreCase(fw.wpath,fw.file)
+                       : MatchWild(fw.wpath,fw.file)) continue;
+         return fw.file;
       }
 
-      if (recmatch) {                                                            //  this record is a match
-         filematch += recmatch;                                                  //  accumulate matches for entire file
-         for (ii = 0; ii < nsrs; ii++) Fmatch[ii] += Rmatch[ii];
-         for (ii = 0; ii < nigs; ii++) Fignore[ii] += Rignore[ii];
-         Nlistfoll = listfoll;                                                   //  set following records to list      2.1
+      if (! fw.dir) {
+         err = walk_opendir(fw);
+         if (err == 1) return 0;                                                 //  all done
+         if (err == 2) {                                                         //  root is a file
+            fw.Nstat++;
+            if (stat(fw.file,&statb) || ! S_ISREG(statb.st_mode)) continue;
+            if (fw.nocase ? MatchWildIgnoreCase(fw.wpath,fw.file)
+                          : MatchWild(fw.wpath,fw.file)) continue;
+            return fw.file;
+         }
+         strcpy(fw.file,fw.curr->path);                                          //  directory path + '/',
+         cc = strlen(fw.file);                                                   //    file names go after
+         if (fw.file[cc-1] != '/') fw.file[cc++] = '/';
+         fw.dircc = cc;
+         fw.namescc = fw.namelast = 0;
       }
 
-      if (recmatch) {                                                            //  print preceding records            1.5
-         for (ii = listprec; ii > 0; ii--)
-            if (pbuff[ii])
-               textwidget_append2(mLog,0,"%5d  %s \n",Nline-ii,pbuff[ii]);
-         Fclearprec = 1;                                                         //  clear preceding records buffer
+      ent = readdir(fw.dir);
+      if (! ent && fw.ibatch < fw.nbatch) {                                      //  walk_small: files of directory,
+         if (fw.ibatch == 0)                                                     //    smallest first
+            qsort(fw.batch,fw.nbatch,sizeof(walkfile),walk_sizecomp);
+         wf = &fw.batch[fw.ibatch++];
+         name = fw.bnames + wf->name;
+         cc = fw.dircc;
+         ncc = strlen(name);
+         memcpy(fw.file+cc,name,ncc+1);
+         dev = wf->dev;
+         ino = wf->ino;
+         atype = fw.archives ? arc_type(name,ncc) : 0;
+         if (fw.track) walk_addname(fw,name);                                    //  read now, for walk_save()
+         goto regfile;
       }
 
-      if (recmatch)
-      {
-         textwidget_append2(mLog,0,"%5d  %s \n",Nline,pbuff[0]);                 //  print matching record              2.5
-
-         for (ii = 0; ii < nsrs; ii++) {                                         //  loop match strings
-            pp = pbuff[0];
-            while (true) {                                                       //  search record
-               pp = recsearch1(pp,srstrings[ii],delims,cc,FignorecaseS);         //  get next matching string and length
-               if (! pp) break;                                                  //  not found
-               line = textwidget_linecount(mLog) - 2;                            //  text report line
-               pos = pp-pbuff[0] + 7;                                            //  string position
-               textwidget_bold_word(mLog,line,pos,cc);                           //  make string bold
-               pp += cc;                                                         //  resume search from string end
-            }
+      if (! ent) {                                                               //  directory done
+         closedir(fw.dir);
+         fw.dir = 0;
+         if (fw.skip) delete fw.skip;
+         fw.skip = 0;
+         fw.nbatch = fw.ibatch = fw.bnamescc = 0;
+         if (fw.order == walk_bfs || fw.order == walk_recent) continue;
+         for (ii = fw.Npush, jj = fw.Nfront-1; ii < jj; ii++, jj--) {            //  reverse its subdirectories
+            dd = fw.frontier[ii];                                                //    to read them in readdir() order
+            fw.frontier[ii] = fw.frontier[jj];
+            fw.frontier[jj] = dd;
          }
+         continue;
       }
 
-      if (recmatch && listprec > 0 && ! listfoll)                                //  add a spacer line if no following  2.1
-         textwidget_append2(mLog,0,"\n");                                        //    records are to be listed
+      name = ent->d_name;
+      if (name[0] == '.' && (! name[1] || (name[1] == '.' && ! name[2])))        //  skip . and ..
+         continue;
+      if (fw.skip && fw.skip->Find(name) >= 0) continue;                         //  read before walk_restore()
+      if (fw.track) walk_addname(fw,name);                                       //  names read, for walk_save()
+      fw.Nentries++;
+
+      cc = fw.dircc;
+      ncc = strlen(name);
+      if (cc + ncc > XFCC-2) continue;                                           //  path too long
+      memcpy(fw.file+cc,name,ncc+1);
+
+      type = ent->d_type;
+      dev = fw.curr->dev;
+      ino = ent->d_ino;
+      statd = 0;
+
+      if (type == DT_LNK || type == DT_UNKNOWN) {                                //  follow symlink, or unknown type
+         fw.Nstat++;
+         if (stat(fw.file,&statb)) continue;                                     //  broken symlink
+         statd = 1;
+         if (S_ISREG(statb.st_mode)) type = DT_REG;
+         else if (S_ISDIR(statb.st_mode)) type = DT_DIR;
+         else continue;
+         dev = statb.st_dev;
+         ino = statb.st_ino;
+      }
 
-      if (! recmatch && Nlistfoll > 0) {
-         textwidget_append2(mLog,0,"%5d  %s \n",Nline,pbuff[ii]);                //  list records following match       2.1
-         Nlistfoll--;
-         if (Nlistfoll == 0) textwidget_append2(mLog,0,"\n");                    //  add a spacer line after following  2.1
-         Fclearprec = 1;                                                         //    records are listed
+      if (fw.gitignore) {                                                        //  ignore files rules
+         if (type == DT_DIR && strmatch(name,".git")) {
+            fw.Xprune++;
+            continue;
+         }
+         if (fw.curr->ignore &&
+             ignore_check(fw.curr->ignore,fw.file,name,type == DT_DIR)) {
+            if (type == DT_DIR) fw.Xprune++;                                     //  folder is not opened
+            else fw.Xigfile++;
+            continue;
+         }
+      }
+
+      if (type == DT_DIR && fw.nprune && walk_prunedir(fw,cc+ncc)) {             //  all files would be ignored
+         fw.Xprune++;
+         continue;
+      }
+
+      if (type == DT_DIR) {                                                      //  add to frontier
+         if (fw.order == walk_recent && ! statd) {                               //  folder mod time needed
+            fw.Nstat++;
+            if (fstatat(dirfd(fw.dir),name,&statb,0)) continue;
+         }
+         dd = (walkdir *) Zarena_alloc(&fw.arena,sizeof(walkdir));
+         dd->path = Zarena_strdup(&fw.arena,fw.file);
+         dd->parent = fw.curr;
+         dd->ignore = fw.curr->ignore;                                           //  inherit rules, until opened
+         dd->mtime = 0;
+         if (fw.order == walk_recent)
+            dd->mtime = statb.st_mtim.tv_sec * 1000000000LL + statb.st_mtim.tv_nsec;
+         walk_push(fw,dd);
+         continue;
+      }
+
+      if (type != DT_REG) continue;                                              //  device, pipe, socket ...
+
+      atype = fw.archives ? arc_type(name,ncc) : 0;                              //  archive, members are matched
+
+      if (! atype && (fw.nocase ? MatchWildIgnoreCase(fw.wpath,fw.file)
+                                : MatchWild(fw.wpath,fw.file))) continue;        //  no match
+
+      if (fw.order == walk_small) {                                              //  return after the directory
+         if (! statd) {                                                          //    is read, by file size
+            fw.Nstat++;
+            if (fstatat(dirfd(fw.dir),name,&statb,0)) continue;
+         }
+         if (fw.track) fw.namescc = fw.namelast;                                 //  not returned yet
+         walk_batch(fw,name,statb.st_size,dev,ino);
+         continue;
+      }
+
+   regfile:
+      if (fw.unique && ! inodeset_add(fw.files,dev,ino)) {                       //  reported before, other path
+         fw.Xdup++;
+         continue;
       }
 
-      if (Fclearprec) {                                                          //  clear preceding records buffer     2.1
-         for (ii = 0; ii <= listprec; ii++) {
-            if (pbuff[ii]) zfree(pbuff[ii]);
-            pbuff[ii] = 0;
+      if (atype) {
+         if (fw.nprune && walk_prunedir(fw,cc+ncc)) {                            //  all members would be ignored
+            fw.Xprune++;
+            continue;
          }
-         Fclearprec = 0;
+         fw.arc = arc_open(fw.file,atype);                                       //  read index or first header
+         if (fw.arc) {
+            fw.arcdone = 0;
+            fw.Narc++;
+            memcpy(fw.file+cc+ncc,"//",3);                                       //  members go after archive//
+            fw.arccc = cc + ncc + 2;
+            continue;
+         }
+         if (fw.nocase ? MatchWildIgnoreCase(fw.wpath,fw.file)                   //  not an archive, normal file
+                       : MatchWild(fw.wpath,fw.file)) continue;
       }
+
+      return fw.file;
    }
+}
 
-   fclose(fid);
 
-   for (ii = 0; ii <= listprec; ii++)                                            //  clear preceding records buffer
-      if (pbuff[ii]) zfree(pbuff[ii]);
+void walk_close(filewalk &fw)                                                    //  2.8
+{
+   if (fw.arc) arc_close(fw.arc);
+   fw.arc = 0;
+   if (fw.dir) closedir(fw.dir);
+   fw.dir = 0;
+   if (fw.frontier) zfree(fw.frontier);
+   fw.frontier = 0;
+   if (fw.names) zfree(fw.names);
+   fw.names = 0;
+   if (fw.skip) delete fw.skip;
+   fw.skip = 0;
+   if (fw.batch) zfree(fw.batch);
+   fw.batch = 0;
+   if (fw.bnames) zfree(fw.bnames);
+   fw.bnames = 0;
+   Zarena_close(&fw.arena);
+   if (fw.unique) {
+      inodeset_close(fw.dirs);
+      inodeset_close(fw.files);
+   }
+   fw.unique = 0;
+   return;
+}
+
 
-   return filematch;
+//  walk_recent: folder d1 is read before d2, modified later or added first
+
+int walk_before(walkdir *d1, walkdir *d2)                                        //  2.8
+{
+   if (d1->mtime != d2->mtime) return (d1->mtime > d2->mtime);
+   return (d1->seq < d2->seq);
 }
 
-/**
- * @brief recsearch - search a single record for strings to match and strings not to match (ignore strings)
- * @param buff
- * @param Rmatch
- * @param nsrs
- * @param Rignore
- * @param nigs
- * @param recmatch
- * @param recignore
- */
-void recsearch(char *buff,                                                       //  record to search
-               int Rmatch[], int nsrs,                                           //  search strings matched
-               int Rignore[], int nigs,                                          //  ignore strings matched
-               int &recmatch, int &recignore)                                    //  returned total counts
+
+//  walk_recent: order of frontier entries, as read
+
+int walk_heapcomp(const void *p1, const void *p2)                                //  2.8
 {
-   char     buff2[1000], *pp, *token;
-   int      ii;
+   walkdir  *d1 = *((walkdir **) p1), *d2 = *((walkdir **) p2);
 
-   strncpy0(buff2,buff,999);                                                     //  copy before destruction by strtok()
+   if (d1 == d2) return 0;
+   return walk_before(d1,d2) ? -1 : 1;
+}
 
-   for (ii = 0; ii < Smax; ii++)                                                 //  no strings found in record yet
-      Rmatch[ii] = Rignore[ii] = 0;
 
-   recmatch = recignore = 0;
-   pp = buff2;
+//  add a folder to the frontier: a stack (walk_dfs, walk_small), a queue
+//  (walk_bfs, read from Nhead), or a heap of the latest mod time (walk_recent)
 
-   if (FignorecaseS)                                                             //  ignore case option        1.7
-   {
-      while (true)
-      {
-         token = strtok(pp,delims);                                              //  get next string defined by delimiters
-         if (! token) break;
-         pp = 0;                                                                 //  for strtok() continuation calls
+void walk_push(filewalk &fw, walkdir *dd)                                        //  2.8
+{
+   walkdir  **frontier2, *pd;
+   int      ii, pp;
 
-         for (ii = 0; ii < nsrs; ii++)
-         {
-            if (MatchWildIgnoreCase(srstrings[ii],token) == 0) {                 //  match with all search strings
-               Rmatch[ii]++;
-               if (Rmatch[ii] == 1) recmatch++;                                  //  search strings found, 0...nsrs
-            }
-         }
+   if (fw.Nfront == fw.Mfront && fw.Nhead > fw.Mfront / 2) {                     //  queue: reuse space before head
+      fw.Nfront -= fw.Nhead;
+      memmove(fw.frontier,fw.frontier + fw.Nhead,fw.Nfront * sizeof(walkdir *));
+      fw.Nhead = 0;
+   }
 
-         if (nsrs == 0) recmatch++;                                              //  no search strings = match
+   if (fw.Nfront == fw.Mfront) {                                                 //  full, double the size
+      frontier2 = (walkdir **) zmalloc(2 * fw.Mfront * sizeof(walkdir *),0);
+      memcpy(frontier2,fw.frontier,fw.Mfront * sizeof(walkdir *));
+      zfree(fw.frontier);
+      fw.frontier = frontier2;
+      fw.Mfront *= 2;
+   }
 
-         for (ii = 0; ii < nigs; ii++)
-         {
-            if (MatchWildIgnoreCase(igstrings[ii],token) == 0) {                 //  match with all ignore strings
-               Rignore[ii]++;
-               if (Rignore[ii] == 1) recignore++;                                //  ignore strings found, 0...nigs
-            }
-         }
-      }
+   dd->seq = fw.Nseq++;
+   ii = fw.Nfront++;
+   fw.frontier[ii] = dd;
+   if (fw.order != walk_recent) return;
+
+   for ( ; ii > 0; ii = pp) {                                                    //  heap: move up past older
+      pp = (ii - 1) / 2;
+      pd = fw.frontier[pp];
+      if (walk_before(pd,dd)) break;
+      fw.frontier[ii] = pd;
+      fw.frontier[pp] = dd;
    }
 
-   else
-   {
-      while (true)
-      {
-         token = strtok(pp,delims);                                              //  get next string defined by delimiters
-         if (! token) break;
-         pp = 0;                                                                 //  for strtok() continuation calls
+   return;
+}
 
-         for (ii = 0; ii < nsrs; ii++)
-         {
-            if (MatchWild(srstrings[ii],token) == 0) {                           //  match with all search strings
-               Rmatch[ii]++;
-               if (Rmatch[ii] == 1) recmatch++;                                  //  search strings found, 0...nsrs
-            }
-         }
 
-         if (nsrs == 0) recmatch++;                                              //  no search strings = match
+//  remove the next folder to read from the frontier, null if none
 
-         for (ii = 0; ii < nigs; ii++)
-         {
-            if (MatchWild(igstrings[ii],token) == 0) {                           //  match with all ignore strings
-               Rignore[ii]++;
-               if (Rignore[ii] == 1) recignore++;                                //  ignore strings found, 0...nigs
-            }
-         }
-      }
+walkdir * walk_pop(filewalk &fw)                                                 //  2.8
+{
+   walkdir  *dd, *last, *cd;
+   int      ii, cc, nn;
+
+   if (fw.Nfront == fw.Nhead) return 0;
+
+   if (fw.order == walk_bfs) {                                                   //  queue
+      dd = fw.frontier[fw.Nhead++];
+      if (fw.Nhead == fw.Nfront) fw.Nhead = fw.Nfront = 0;
+      return dd;
    }
 
-   return;
+   if (fw.order != walk_recent) return fw.frontier[--fw.Nfront];                 //  stack
+
+   dd = fw.frontier[0];                                                          //  heap: latest mod time
+   last = fw.frontier[--fw.Nfront];
+   nn = fw.Nfront;
+
+   for (ii = 0; (cc = 2 * ii + 1) < nn; ii = cc) {                               //  move last down from top
+      if (cc + 1 < nn && walk_before(fw.frontier[cc+1],fw.frontier[cc])) cc++;
+      cd = fw.frontier[cc];
+      if (walk_before(last,cd)) break;
+      fw.frontier[ii] = cd;
+   }
+
+   if (nn) fw.frontier[ii] = last;
+   return dd;
 }
 
 
-//
-/**
- * @brief recsearch1 - Search a record for a string between delimiters which matches an input wildcard string.
- *                     Returns position of matching string within record, and its length in 'cc'.
- *                     Returns null if no match is found.
- *                     If ignorecase is not null, case is ignored in the string comparison.
- * @param record
- * @param wildstr
- * @param delims
- * @param cc
- * @param ignorecase
- * @return
- */
-char* recsearch1(char* const record, char* const wildstr, char* const delims, int& cc, bool ignorecase){                               // 2.5
-  char     *pp1, *pp2, delim;
-  int      mm;
-  pp1 = record;
+//  walk_small: add a file of the folder being read, returned when the
+//  folder is read, smallest first
 
-  while (true){
+void walk_batch(filewalk &fw, cchar *name, int64 size, dev_t dev, ino_t ino)     //  2.8
+{
+   int      cc = strlen(name) + 1;
+   walkfile *wf;
+   char     *names2;
+
+   if (fw.nbatch == fw.mbatch) {
+      fw.mbatch = 2 * fw.mbatch + 256;
+      wf = (walkfile *) zmalloc(fw.mbatch * sizeof(walkfile),0);
+      if (fw.nbatch) memcpy(wf,fw.batch,fw.nbatch * sizeof(walkfile));
+      if (fw.batch) zfree(fw.batch);
+      fw.batch = wf;
+   }
+
+   if (fw.bnamescc + cc > fw.bnamescap) {
+      fw.bnamescap = 2 * fw.bnamescap + cc + 4096;
+      names2 = (char *) zmalloc(fw.bnamescap,0);
+      if (fw.bnamescc) memcpy(names2,fw.bnames,fw.bnamescc);
+      if (fw.bnames) zfree(fw.bnames);
+      fw.bnames = names2;
+   }
+
+   wf = &fw.batch[fw.nbatch++];
+   wf->size = size;
+   wf->name = fw.bnamescc;
+   wf->dev = dev;
+   wf->ino = ino;
+   memcpy(fw.bnames+fw.bnamescc,name,cc);
+   fw.bnamescc += cc;
+   return;
+}
+
+
+//  test if a folder can be skipped because the ignore file patterns would
+//  ignore every file in it: a pattern ending with '*' that matches the
+//  folder path + '/' also matches the path of any file below the folder.
+//  e.g. */.git/* or /home/*/build/*    (folder path in fw.file[0..cc-1])
+//  returns 1 to skip the folder
+
+int walk_prunedir(filewalk &fw, int cc)                                          //  2.8
+{
+   int      ii, pcc, match = 0;
+
+   fw.file[cc] = '/';
+   fw.file[cc+1] = 0;
+
+   for (ii = 0; ii < fw.nprune; ii++) {
+      pcc = strlen(fw.prune[ii]);
+      if (fw.prune[ii][pcc-1] != '*') continue;
+      if (MatchWild(fw.prune[ii],fw.file) == 0) { match = 1; break; }
+   }
+
+   fw.file[cc] = 0;
+   return match;
+}
+
+
+//  add a name read from the current folder to fw.names, for walk_save()
+
+void walk_addname(filewalk &fw, cchar *name)                                     //  2.8
+{
+   int      cc = strlen(name) + 1;
+   char     *names2;
+
+   if (fw.namescc + cc > fw.namescap) {
+      fw.namescap = 2 * fw.namescap + cc + 4096;
+      names2 = (char *) zmalloc(fw.namescap,0);
+      if (fw.namescc) memcpy(names2,fw.names,fw.namescc);
+      if (fw.names) zfree(fw.names);
+      fw.names = names2;
+   }
+
+   fw.namelast = fw.namescc;
+   memcpy(fw.names+fw.namescc,name,cc);
+   fw.namescc += cc;
+   return;
+}
+
+
+//  save the walk position for walk_restore(), for a search checkpoint.
+//  The position is the folder being read and the names read from it,
+//  the archive being listed and its members listed, the frontier paths,
+//  and the (dev, ino) sets for 'unique'. With done = 0 the last file
+//  returned was not searched, and is returned again after walk_restore().
+//  Needs walk_open() option walk_track.
+
+void walk_save(filewalk &fw, FILE *fid, int done)                                //  2.8
+{
+   using namespace ckpt_names;
+
+   int      flags = 0, ii, nn, cc, shard;
+   int64    arcdone;
+   char     key[12];
+   cchar    *pp;
+   STATB    statb;
+   Zhash    *table;
+
+   if (fw.dir) flags |= 1;
+   if (fw.arc) flags |= 2;
+   putcc(fid,&flags,sizeof(int));
+
+   if (fw.dir) {                                                                 //  folder, names read
+      putstr(fid,fw.curr->path);
+      putcc(fid,&fw.Npush,sizeof(int));
+      cc = fw.namescc;
+      if (! done && ! fw.arc) cc = fw.namelast;                                  //  last file, read again
+      putcc(fid,&cc,sizeof(int));
+      putcc(fid,fw.names,cc);
+   }
+
+   if (fw.arc) {                                                                 //  archive, members listed
+      putcc(fid,&fw.arccc,sizeof(int));
+      putcc(fid,fw.file,fw.arccc-2);                                             //  archive path
+      putcc(fid,&fw.arc->type,sizeof(int));
+      arcdone = fw.arcdone - (done ? 0 : 1);
+      putcc(fid,&arcdone,sizeof(int64));
+   }
+
+   if (fw.order == walk_recent)                                                  //  heap in read order (still a heap),
+      qsort(fw.frontier,fw.Nfront,sizeof(walkdir *),walk_heapcomp);              //    added again in this order
+
+   nn = fw.Nfront - fw.Nhead;
+   if (! done && ! fw.dir && ! fw.arc) nn++;                                     //  root is a file, again
+   putcc(fid,&nn,sizeof(int));
+   for (ii = fw.Nhead; ii < fw.Nfront; ii++)
+      putstr(fid,fw.frontier[ii]->path);
+   if (nn > fw.Nfront - fw.Nhead) putstr(fid,fw.file);
+
+   if (! fw.unique) return;
+
+   shard = -1;                                                                   //  last file, report again
+   if (! done && fw.dir && ! fw.arc && stat(fw.file,&statb) == 0)
+      shard = inodeset_key(key,statb.st_dev,statb.st_ino);
+
+   if (shard >= 0 && fw.files.table[shard]->Find(key,12) < 0) shard = -1;
+
+   for (int set = 0; set < 2; set++)                                             //  directories, files read
+   {
+      for (nn = ii = 0; ii < inodeshards; ii++)
+         nn += (set ? fw.files : fw.dirs).table[ii]->GetCount();
+      if (set && shard >= 0) nn--;
+      putcc(fid,&nn,sizeof(int));
+
+      for (ii = 0; ii < inodeshards; ii++)
+      {
+         table = (set ? fw.files : fw.dirs).table[ii];
+         for (int ent = table->GetNext(-1); ent >= 0; ent = table->GetNext(ent)) {
+            pp = table->Key(ent);
+            if (set && ii == shard && memcmp(pp,key,12) == 0) continue;
+            putcc(fid,pp,12);
+         }
+      }
+   }
+
+   return;
+}
+
+
+//  get the walker entry of a folder above the position of walk_restore(),
+//  opened for its (dev, ino) and its ignore files, as when the walk read it.
+//  path[0..cc-1] is the folder, chain has the entries made before.
+
+walkdir * walk_chain(filewalk &fw, Zhash *chain, cchar *root, cchar *path, int cc)
+{
+   walkdir  *dd, *pd = 0;
+   STATB    statb;
+   int      ent, rootcc, pcc, fd, added;
+
+   if (cc > 1 && path[cc-1] == '/') cc--;                                        //  key without trailing '/'
+   ent = chain->Find(path,cc);
+   if (ent >= 0) return (walkdir *) chain->Value(ent);
+
+   rootcc = strlen(root);
+   if (rootcc > 1 && root[rootcc-1] == '/') rootcc--;
+   if (cc > rootcc) {                                                            //  below root: parent folder
+      for (pcc = cc - 1; pcc > 0 && path[pcc] != '/'; pcc--);
+      pd = walk_chain(fw,chain,root,path,pcc ? pcc : 1);
+   }
+
+   dd = (walkdir *) Zarena_alloc(&fw.arena,sizeof(walkdir));
+   dd->path = (char *) Zarena_alloc(&fw.arena,cc+1);
+   memcpy(dd->path,path,cc);
+   dd->path[cc] = 0;
+   dd->parent = pd;
+   dd->ignore = pd ? pd->ignore : 0;
+   dd->dev = 0;
+   dd->ino = 0;
+
+   fd = open(dd->path,O_RDONLY | O_DIRECTORY);
+   if (fd >= 0) {
+      if (fstat(fd,&statb) == 0) {
+         dd->dev = statb.st_dev;
+         dd->ino = statb.st_ino;
+      }
+      if (fw.gitignore) dd->ignore = ignore_load(fw,dd,fd);
+      close(fd);
+   }
+
+   ent = chain->Put(path,cc,added);
+   chain->Value(ent) = (int64) dd;
+   return dd;
+}
+
+
+//  continue a walk from walk_save(), after walk_open() with the same path
+//  and options. Folders and archives that are gone are skipped.
+//  returns 0 if OK, 1 if the saved data is not valid
+
+int walk_restore(filewalk &fw, FILE *fid)                                        //  2.8
+{
+   using namespace ckpt_names;
+
+   char     root[XFCC], path[XFCC], key[12], *pp;
+   int      flags, ii, nn, cc, pcc, type, added;
+   int64    arcdone;
+   uint     dev32;
+   uint64   ino64;
+   walkdir  *dd;
+   Zhash    *chain;
+   STATB    statb;
+
+   strncpy0(root,fw.frontier[0]->path,XFCC);                                     //  walk_open() frontier: root
+   fw.Nfront = fw.Nhead = 0;
+   fw.Nseq = 0;
+   chain = new Zhash(64);
+   Ferr = 0;
+
+   getcc(fid,&flags,sizeof(int));
+
+   if (flags & 1) {                                                              //  folder being read
+      getstr(fid,path,XFCC);
+      getcc(fid,&fw.Npush,sizeof(int));
+      getcc(fid,&cc,sizeof(int));
+      if (cc < 0 || cc > 1000000000) cc = 0, Ferr = 1;
+      if (cc) {                                                                  //  names read
+         fw.namescap = cc + 4096;
+         fw.names = (char *) zmalloc(fw.namescap,0);
+         getcc(fid,fw.names,cc);
+         if (fw.names[cc-1]) Ferr = 1;
+      }
+      fw.namescc = fw.namelast = cc;
+
+      fw.skip = new Zhash(1024);                                                 //  skip names read before
+      for (pp = fw.names; ! Ferr && pp < fw.names + fw.namescc; pp += strlen(pp) + 1)
+         fw.skip->Put(pp,added);
+
+      dd = walk_chain(fw,chain,root,path,strlen(path));                          //  with parents, ignore rules
+      fw.dir = opendir(dd->path);
+      if (fw.dir) {
+         fw.curr = dd;
+         strcpy(fw.file,dd->path);
+         cc = strlen(fw.file);
+         if (fw.file[cc-1] != '/') fw.file[cc++] = '/';
+         fw.dircc = cc;
+      }
+   }
+
+   if (flags & 2) {                                                              //  archive being listed
+      getcc(fid,&cc,sizeof(int));
+      if (cc < 3 || cc > XFCC-2) cc = 3, Ferr = 1;
+      getcc(fid,path,cc-2);
+      path[cc-2] = 0;
+      getcc(fid,&type,sizeof(int));
+      getcc(fid,&arcdone,sizeof(int64));
+      if (! Ferr && fw.dir) fw.arc = arc_open(path,type);
+      if (fw.arc) {
+         for (fw.arcdone = 0; fw.arcdone < arcdone && arc_next(fw.arc); fw.arcdone++);
+         memcpy(fw.file,path,cc-2);
+         memcpy(fw.file+cc-2,"//",3);
+         fw.arccc = cc;
+      }
+   }
+
+   getcc(fid,&nn,sizeof(int));                                                   //  frontier
+   if (nn < 0 || nn > 100000000) nn = 0, Ferr = 1;
+   if (nn > fw.Mfront) {
+      zfree(fw.frontier);
+      fw.Mfront = nn + 1000;
+      fw.frontier = (walkdir **) zmalloc(fw.Mfront * sizeof(walkdir *),0);
+   }
+
+   for (ii = 0; ii < nn && ! Ferr; ii++)
+   {
+      getstr(fid,path,XFCC);
+      dd = (walkdir *) Zarena_alloc(&fw.arena,sizeof(walkdir));
+      dd->path = Zarena_strdup(&fw.arena,path);
+      dd->parent = 0;
+      if (! strmatch(path,root)) {                                               //  parent folder, from chain
+         for (pcc = strlen(path) - 1; pcc > 0 && path[pcc] != '/'; pcc--);
+         dd->parent = walk_chain(fw,chain,root,path,pcc ? pcc : 1);
+      }
+      dd->ignore = dd->parent ? dd->parent->ignore : 0;                          //  inherit rules, until opened
+      dd->mtime = 0;
+      if (fw.order == walk_recent && stat(path,&statb) == 0)
+         dd->mtime = statb.st_mtim.tv_sec * 1000000000LL + statb.st_mtim.tv_nsec;
+      walk_push(fw,dd);
+   }
+
+   if (fw.Npush > fw.Nfront) fw.Npush = fw.Nfront;
+
+   for (int set = 0; fw.unique && set < 2; set++)                                //  directories, files read
+   {
+      getcc(fid,&nn,sizeof(int));
+      for (ii = 0; ii < nn && ! Ferr; ii++) {
+         getcc(fid,key,12);
+         memcpy(&ino64,key,8);
+         memcpy(&dev32,key+8,4);
+         inodeset_add(set ? fw.files : fw.dirs,dev32,ino64);
+      }
+   }
+
+   delete chain;
+   return Ferr;
+}
+
+
+//  load the ignore files of a folder, compile their rules, and return the
+//  rules for the folder entries: these rules, then the rules from above.
+//  Rule syntax is as for .gitignore: # comment, !negate, trailing '/' for
+//  folders only, a '/' elsewhere anchors the pattern to the folder of the
+//  ignore file, else it matches a file or folder name at any level.
+//  Later rules override earlier rules, lower folders override higher ones.
+
+ignoreset * ignore_load(filewalk &fw, walkdir *dd, int dfd)                      //  2.8
+{
+   cchar       *names[3] = { ".gitignore", ".ignore", ".findwildignore" };
+   char        *text[3], *pp, *line, *end;
+   int         ii, fd, cc, nn, nrules = 0;
+   STATB       statb;
+   igrule      *rule;
+   ignoreset   *set;
+
+   for (ii = 0; ii < 3; ii++)                                                    //  read files into arena
+   {
+      text[ii] = 0;
+      fd = openat(dfd,names[ii],O_RDONLY);
+      if (fd < 0) continue;
+      if (fstat(fd,&statb) || ! S_ISREG(statb.st_mode) || statb.st_size > 1000000) {
+         close(fd);
+         continue;
+      }
+      cc = statb.st_size;
+      text[ii] = (char *) Zarena_alloc(&fw.arena,cc+1);
+      nn = read(fd,text[ii],cc);
+      close(fd);
+      if (nn < 0) nn = 0;
+      text[ii][nn] = 0;
+      fw.Nigfiles++;
+      for (pp = text[ii]; *pp; pp++) if (*pp == '\n') nrules++;                  //  max. rules
+      nrules++;
+   }
+
+   if (! nrules) return dd->ignore;                                              //  no ignore files here
+
+   set = (ignoreset *) Zarena_alloc(&fw.arena,sizeof(ignoreset));
+   set->parent = dd->ignore;
+   set->basecc = strlen(dd->path);
+   if (dd->path[set->basecc-1] != '/') set->basecc++;
+   set->rules = (igrule *) Zarena_alloc(&fw.arena,nrules * sizeof(igrule));
+   set->nrules = 0;
+
+   for (ii = 0; ii < 3; ii++)
+   {
+      for (line = text[ii]; line && *line; line = end)
+      {
+         end = strchr(line,'\n');                                                //  next line
+         if (end) *end++ = 0;
+         else end = line + strlen(line);
+
+         cc = strlen(line);
+         if (cc && line[cc-1] == '\r') line[--cc] = 0;                           //  CRLF
+         while (cc && line[cc-1] == ' ' && (cc < 2 || line[cc-2] != '\\'))       //  trailing blanks, unless \ escaped
+            line[--cc] = 0;
+         if (! cc || *line == '#') continue;                                     //  blank line, comment
+
+         rule = set->rules + set->nrules;
+         memset(rule,0,sizeof(igrule));
+
+         if (*line == '!') { rule->negate = 1; line++; cc--; }
+         else if (*line == '\\' && (line[1] == '#' || line[1] == '!')) { line++; cc--; }
+         if (cc && line[cc-1] == '/') { rule->dironly = 1; line[--cc] = 0; }
+         if (strchr(line,'/')) rule->anchored = 1;
+         if (*line == '/') { line++; cc--; }
+         if (! cc) continue;
+
+         rule->pattern = line;
+         if (! strpbrk(line,"*?[\\")) rule->type = rule_literal;
+         else if (*line == '*' && ! rule->anchored && ! strpbrk(line+1,"*?[\\")) {
+            rule->type = rule_suffix;
+            rule->pattern = line + 1;
+         }
+         else rule->type = rule_glob;
+
+         set->nrules++;
+      }
+   }
+
+   if (! set->nrules) return dd->ignore;
+   return set;
+}
+
+
+//  test a folder entry against the ignore rules
+//  path: full path of entry, name: name part, isdir: entry is a folder
+//  returns 1 if the entry is ignored
+
+int ignore_check(ignoreset *set, cchar *path, cchar *name, int isdir)            //  2.8
+{
+   igrule      *rule;
+   cchar       *string;
+   int         ii, cc, cc2, match;
+
+   for ( ; set; set = set->parent)                                               //  lowest folder first
+   {
+      for (ii = set->nrules - 1; ii >= 0; ii--)                                  //  last rule first
+      {
+         rule = set->rules + ii;
+         if (rule->dironly && ! isdir) continue;
+         string = rule->anchored ? path + set->basecc : name;
+
+         if (rule->type == rule_literal)
+            match = strmatch(rule->pattern,string);
+         else if (rule->type == rule_suffix) {
+            cc = strlen(string);
+            cc2 = strlen(rule->pattern);
+            match = cc >= cc2 && strmatch(rule->pattern,string + cc - cc2);
+         }
+         else match = ignore_glob(rule->pattern,string);
+
+         if (match) return ! rule->negate;
+      }
+   }
+
+   return 0;
+}
+
+
+//  wildcard match with .gitignore rules: '*' and '?' do not match '/',
+//  [abc] [a-z] [!a-z] match one character, "**/" matches zero or more
+//  folders, a trailing "/**" matches everything below, '\' escapes.
+//  returns 1 if match
+
+int ignore_glob(cchar *pattern, cchar *string)                                   //  2.8
+{
+   cchar    *pp = pattern, *ss = string;
+   int      negate, match;
+
+   while (*pp)
+   {
+      if (pp[0] == '*' && pp[1] == '*' &&                                        //  ** as a whole path segment
+          (pp == pattern || pp[-1] == '/') && (pp[2] == '/' || ! pp[2]))
+      {
+         if (! pp[2]) return 1;                                                  //  trailing **: all below
+         pp += 3;                                                                //  **/: zero or more folders
+         while (true) {
+            if (ignore_glob(pp,ss)) return 1;
+            ss = strchr(ss,'/');
+            if (! ss) return 0;
+            ss++;
+         }
+      }
+
+      if (*pp == '*') {                                                          //  any characters except '/'
+         while (*pp == '*') pp++;
+         while (true) {
+            if (ignore_glob(pp,ss)) return 1;
+            if (! *ss || *ss == '/') return 0;
+            ss++;
+         }
+      }
+
+      if (! *ss) return 0;
+
+      if (*pp == '?') {                                                          //  any character except '/'
+         if (*ss == '/') return 0;
+         pp++;
+         ss++;
+         continue;
+      }
+
+      if (*pp == '[' && strchr(pp+1,']')) {                                      //  character class
+         pp++;
+         negate = (*pp == '!' || *pp == '^');
+         if (negate) pp++;
+         match = 0;
+         do {
+            if (pp[1] == '-' && pp[2] && pp[2] != ']') {                         //  range a-z
+               if (*ss >= pp[0] && *ss <= pp[2]) match = 1;
+               pp += 3;
+            }
+            else if (*pp++ == *ss) match = 1;
+         } while (*pp && *pp != ']');
+         if (*pp) pp++;
+         if (match == negate || *ss == '/') return 0;
+         ss++;
+         continue;
+      }
+
+      if (*pp == '\\' && pp[1]) pp++;                                            //  escaped character
+      if (*pp++ != *ss++) return 0;
+   }
+
+   return *ss == 0;
+}
+
+
+//  archives: tar (also compressed: gzip, xz, zstd) and zip files are listed
+//  by the walker as virtual folders, members as archive//path/in/archive.
+//  A zip file is mapped and its central directory is read, members are then
+//  found at their offsets. A tar file has no index: headers are read in turn
+//  and the data of members not searched is skipped (lseek, if not compressed).
+//  Members are read from the archive, never extracted to disk.
+
+namespace arc_names
+{
+   arcfile  *arclisted = 0;                                                      //  archive with member just listed
+
+   int arc_fill(arcfile *arc);
+   int64 arc_input(arcfile *arc, char *buff, int64 cc);
+   void arc_skip(arcfile *arc, int64 cc);
+   int64 tar_number(cchar *field, int cc);
+   int tar_check(cchar *header);
+   cchar * tar_next(arcfile *arc);
+   cchar * zip_next(arcfile *arc);
+   int zip_open(arcfile *arc);
+   uint zip16(cchar *pp) { const uchar *uu = (const uchar *) pp; return uu[0] | uu[1] << 8; }
+   uint zip32(cchar *pp) { return zip16(pp) | zip16(pp+2) << 16; }
+   uint64 zip64(cchar *pp) { return zip32(pp) | (uint64) zip32(pp+4) << 32; }
+}
+
+
+//  get archive type from file name (cc), returns arc_tar/zip or 0
+//  compressed tar files only if files are decompressed (not --raw)
+
+int arc_type(cchar *name, int cc)                                                //  2.8
+{
+   cchar    *suffix[9] = { ".tar", ".tar.gz", ".tgz", ".tar.xz", ".txz",
+                           ".tar.zst", ".tzst", ".zip", ".jar" };
+   int      ii, scc;
+
+   for (ii = 0; ii < 9; ii++) {
+      if (! Funpack && ii > 0 && ii < 7) continue;                               //  compressed tar
+      scc = strlen(suffix[ii]);
+      if (cc > scc && strncasecmp(name+cc-scc,suffix[ii],scc) == 0)
+         return (ii < 7) ? arc_tar : arc_zip;
+   }
+
+   return 0;
+}
+
+
+//  find the archive part of an archive member path: /.../file.tar.gz//member
+//  returns the archive path cc, or 0 if not an archive member
+
+int arc_split(cchar *file)                                                       //  2.8
+{
+   cchar    *pp;
+
+   for (pp = strstr(file,"//"); pp; pp = strstr(pp+1,"//"))
+      if (pp > file && pp[2] && arc_type(file,pp-file)) return pp - file;
+   return 0;
+}
+
+
+//  open an archive file, read the zip central directory or check the
+//  first tar header. returns null if the file is not a valid archive.
+
+arcfile * arc_open(cchar *file, int type)                                        //  2.8
+{
+   using namespace arc_names;
+
+   arcfile  *arc;
+   STATB    statb;
+   int      ztype, fd;
+   int64    nread;
+
+   fd = open(file,O_RDONLY);
+   if (fd < 0) return 0;
+
+   arc = (arcfile *) zmalloc(sizeof(arcfile));
+   arc->type = type;
+   arc->fd = fd;
+   arc->path = zstrdup(file);
+
+   if (type == arc_zip) {
+      if (zip_open(arc)) return arc;
+      arc_close(arc);
+      return 0;
+   }
+
+   arc->buff = (char *) zmalloc(arcbuffcc,0);                                    //  tar, maybe compressed
+   if (fstat(fd,&statb) == 0) arc->filecc = statb.st_size;
+   do nread = read(fd,arc->buff,arcbuffcc);
+   while (nread < 0 && errno == EINTR);
+   if (nread > 0) arc->bend = nread;
+
+   ztype = unpack_type(arc->buff,arc->bend);
+   if (ztype) {                                                                  //  decompress, input is this block,
+      arc->zs = unpack_open(ztype,fd,arc->buff,arc->bend);                       //    then the rest of the file
+      arc->bend = 0;
+   }
+
+   if ((! ztype || arc->zs) && arc_fill(arc) >= 512                              //  valid tar header
+                            && tar_check(arc->buff)) return arc;
+   arc_close(arc);
+   return 0;
+}
+
+
+//  get next archive member (regular file), skip the rest of the prior one
+//  returns member name, or null if no more members
+
+cchar * arc_next(arcfile *arc)                                                   //  2.8
+{
+   using namespace arc_names;
+
+   cchar    *name = 0;
+
+   while (true)
+   {
+      if (arc->type == arc_tar) name = tar_next(arc);
+      else name = zip_next(arc);
+      if (! name) return 0;
+
+      if (strmatchN(name,"./",2)) name += 2;                                     //  ./dir/file >> dir/file
+      while (*name == '/') name++;
+      if (*name) break;
+   }
+
+   if (name != arc->name) memmove(arc->name,name,strlen(name)+1);
+   arclisted = arc;
+   return arc->name;
+}
+
+
+//  read data of current member, up to cc bytes
+//  returns bytes read, 0 at the end of the member
+
+int64 arc_read(arcfile *arc, char *buff, int64 cc)                               //  2.8
+{
+   using namespace arc_names;
+
+   int64    nn, space;
+   int      ret, end = 0;
+
+   if (arc->type == arc_tar) {
+      if (cc > arc->mcc - arc->mread) cc = arc->mcc - arc->mread;
+      if (cc <= 0) return 0;
+      nn = arc_input(arc,buff,cc);
+      if (nn == 0) arc->error = 1;                                               //  truncated
+      arc->mread += nn;
+      return nn;
+   }
+
+   if (arc->method == 0) {                                                       //  zip: stored
+      nn = arc->zcc - arc->mread;
+      if (nn > cc) nn = cc;
+      memcpy(buff,arc->zdata + arc->mread,nn);
+      arc->mread += nn;
+      return nn;
+   }
+
+   if (arc->gzopen < 0) return 0;                                                //  zip: deflated, ended
+
+   if (! arc->gzopen) {
+      memset(&arc->gz,0,sizeof(z_stream));
+      if (inflateInit2(&arc->gz,-15) != Z_OK) {                                  //  raw deflate data
+         arc->error = 1;
+         return 0;
+      }
+      arc->gzopen = 1;
+   }
+
+   if (cc > 1 << 30) cc = 1 << 30;
+   arc->gz.next_out = (Bytef *) buff;
+   arc->gz.avail_out = cc;
+
+   while (arc->gz.avail_out == cc)                                               //  until some output
+   {
+      if (! arc->gz.avail_in) {                                                  //  input in 1 GB parts
+         space = arc->zcc - arc->zpos;
+         if (space > 1 << 30) space = 1 << 30;
+         arc->gz.next_in = (Bytef *) arc->zdata + arc->zpos;
+         arc->gz.avail_in = space;
+         arc->zpos += space;
+      }
+      ret = inflate(&arc->gz,Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) { end = 1; break; }
+      if (ret == Z_BUF_ERROR && arc->zpos < arc->zcc) continue;
+      if (ret != Z_OK) {                                                         //  corrupt or truncated
+         arc->error = 1;
+         break;
+      }
+   }
+
+   nn = cc - arc->gz.avail_out;
+   arc->mread += nn;
+   if (end || nn == 0) {                                                         //  member done
+      inflateEnd(&arc->gz);
+      arc->gzopen = -1;
+   }
+   return nn;
+}
+
+
+void arc_close(arcfile *arc)                                                     //  2.8
+{
+   using namespace arc_names;
+
+   if (arclisted == arc) arclisted = 0;
+   if (arc->zs) unpack_close(arc->zs);
+   if (arc->gzopen > 0) inflateEnd(&arc->gz);
+   if (arc->map) munmap(arc->map,arc->mapcc);
+   if (arc->buff) zfree(arc->buff);
+   close(arc->fd);
+   zfree(arc->path);
+   zfree(arc);
+   return;
+}
+
+
+//  tar: fill input buffer if empty, returns bytes in buffer
+
+int arc_names::arc_fill(arcfile *arc)
+{
+   int64    nread;
+
+   if (arc->bpos < arc->bend) return arc->bend - arc->bpos;
+
+   arc->bpos = arc->bend = 0;
+   do {
+      if (arc->zs) nread = unpack_read(arc->zs,arc->buff,arcbuffcc);
+      else nread = read(arc->fd,arc->buff,arcbuffcc);
+   } while (nread < 0 && errno == EINTR);
+   if (nread > 0) arc->bend = nread;
+   return arc->bend;
+}
+
+
+//  tar: read up to cc bytes, returns bytes read, 0 at the end
+
+int64 arc_names::arc_input(arcfile *arc, char *buff, int64 cc)
+{
+   int64    nn;
+
+   if (arc->bpos == arc->bend && cc >= arcbuffcc) {                              //  large read, not via buffer
+      do {
+         if (arc->zs) nn = unpack_read(arc->zs,buff,cc);
+         else nn = read(arc->fd,buff,cc);
+      } while (nn < 0 && errno == EINTR);
+      return (nn > 0) ? nn : 0;
+   }
+
+   nn = arc_fill(arc);
+   if (nn > cc) nn = cc;
+   memcpy(buff,arc->buff + arc->bpos,nn);
+   arc->bpos += nn;
+   return nn;
+}
+
+
+//  tar: skip cc bytes of input
+
+void arc_names::arc_skip(arcfile *arc, int64 cc)
+{
+   int64    nn;
+
+   if (cc <= 0) return;
+   nn = arc->bend - arc->bpos;                                                   //  skip buffered data
+   if (nn > cc) nn = cc;
+   arc->bpos += nn;
+   cc -= nn;
+   if (cc == 0) return;
+
+   if (! arc->zs) {                                                              //  not compressed: seek
+      lseek(arc->fd,cc,SEEK_CUR);
+      return;
+   }
+
+   while (cc > 0 && arc_fill(arc)) {                                             //  compressed: decompress and discard
+      nn = arc->bend - arc->bpos;
+      if (nn > cc) nn = cc;
+      arc->bpos += nn;
+      cc -= nn;
+   }
+   return;
+}
+
+
+//  tar: get number from octal digits, or base-256 if the first bit is set
+//  returns -1 if negative or too big (base-256)
+
+int64 arc_names::tar_number(cchar *field, int cc)
+{
+   const uchar *uu = (const uchar *) field;
+   int64       nn = 0;
+   int         ii = 0;
+
+   if (uu[0] & 0x80) {                                                           //  GNU base-256
+      if (uu[0] & 0x40) return -1;                                               //  negative
+      nn = uu[0] & 0x3f;
+      for (ii = 1; ii < cc; ii++) {
+         if (nn > (INT64_MAX >> 8)) return -1;
+         nn = (nn << 8) | uu[ii];
+      }
+      return nn;
+   }
+
+   while (ii < cc && uu[ii] == ' ') ii++;
+   while (ii < cc && uu[ii] >= '0' && uu[ii] <= '7') nn = nn * 8 + uu[ii++] - '0';
+   return nn;
+}
+
+
+//  tar: check header checksum (sum of header bytes, checksum field as blanks)
+//  returns 1 if OK
+
+int arc_names::tar_check(cchar *header)
+{
+   const uchar *uu = (const uchar *) header;
+   int64       sum = 8 * ' ';
+
+   for (int ii = 0; ii < 512; ii++)
+      if (ii < 148 || ii >= 156) sum += uu[ii];
+   return (sum == tar_number(header+148,8));
+}
+
+
+//  tar: read headers up to the next regular file
+//  GNU long names ('L') and pax path records ('x') apply to the next header
+
+cchar * arc_names::tar_next(arcfile *arc)
+{
+   char     header[512], *data, *pp, *pe;
+   int64    size, nn;
+   int      ii, type, longname = 0;
+
+   arc_skip(arc,arc->mcc - arc->mread + arc->mpad);                              //  rest of prior member
+   arc->mcc = arc->mread = arc->mpad = 0;
+
+   while (true)
+   {
+      for (nn = 0; nn < 512; nn += ii) {                                         //  next header
+         ii = arc_input(arc,header+nn,512-nn);
+         if (! ii) break;
+      }
+      if (nn < 512) {                                                            //  no end blocks
+         if (nn) arc->error = 1;
+         return 0;
+      }
+
+      for (ii = 0; ii < 512 && ! header[ii]; ii++);
+      if (ii == 512) return 0;                                                   //  zero block, end of archive
+      if (! tar_check(header)) {
+         arc->error = 1;
+         return 0;
+      }
+
+      size = tar_number(header+124,12);
+      if (size < 0 || (! arc->zs && size > arc->filecc + arc->bend - arc->bpos   //  bad size, past the end of file
+                                             - lseek(arc->fd,0,SEEK_CUR))) {
+         arc->error = 1;
+         return 0;
+      }
+      type = header[156];
+
+      if (type == 'L' || type == 'x') {                                          //  long name for next header
+         if (size > 1000000) {
+            arc_skip(arc,(size + 511) & ~511);
+            continue;
+         }
+         data = (char *) zmalloc(size+1,0);
+         for (nn = 0; nn < size; nn += ii) {
+            ii = arc_input(arc,data+nn,size-nn);
+            if (! ii) break;
+         }
+         data[nn] = 0;
+         arc_skip(arc,((size + 511) & ~511) - size);
+
+         if (type == 'L') {
+            strncpy0(arc->name,data,XFCC);
+            longname = 1;
+         }
+         else for (pp = data; pp < data + nn; pp = pe) {                         //  pax records: "cc key=value\n"
+            ii = atoi(pp);
+            if (ii < 7 || ii > data + nn - pp) break;                            //  bad record, ignore the rest
+            pe = pp + ii;
+            if (pe[-1] != '\n') break;
+            pp = strchr(pp,' ');
+            if (! pp || pe - pp < 7) break;
+            if (strmatchN(pp+1,"path=",5) && pe - pp - 7 < XFCC) {               //  key within the record
+               memcpy(arc->name,pp+6,pe - pp - 7);                               //  value without \n
+               arc->name[pe - pp - 7] = 0;
+               longname = 1;
+            }
+         }
+         zfree(data);
+         continue;
+      }
+
+      if (type != '0' && type != 0 && type != '7') {                             //  folder, link, device ...
+         arc_skip(arc,(size + 511) & ~511);
+         longname = 0;
+         continue;
+      }
+
+      if (! longname) {
+         arc->name[0] = 0;
+         if (strmatchN(header+257,"ustar",5) && header[345]) {                   //  ustar: prefix/name
+            strncpy0(arc->name,header+345,156);
+            strcat(arc->name,"/");
+         }
+         ii = strlen(arc->name);
+         memcpy(arc->name+ii,header,100);
+         arc->name[ii+100] = 0;
+      }
+      longname = 0;
+
+      arc->mcc = size;
+      arc->mread = 0;
+      arc->mpad = ((size + 511) & ~511) - size;
+      arc->mtime = tar_number(header+136,12);
+
+      ii = strlen(arc->name);
+      if (ii && arc->name[ii-1] == '/') {                                        //  old format folder
+         arc_skip(arc,size + arc->mpad);
+         arc->mcc = arc->mpad = 0;
+         continue;
+      }
+      return arc->name;
+   }
+}
+
+
+//  zip: map the file, find the central directory (also zip64)
+//  returns 1 if OK
+
+int arc_names::zip_open(arcfile *arc)
+{
+   STATB    statb;
+   void     *map;
+   cchar    *eocd, *pp;
+   int64    cc, cdcc, cdpos, loc, ii;
+
+   if (fstat(arc->fd,&statb) || statb.st_size < 22) return 0;
+   cc = statb.st_size;
+
+   map = mmap(0,cc,PROT_READ,MAP_PRIVATE,arc->fd,0);
+   if (map == MAP_FAILED) return 0;
+   arc->map = (char *) map;
+   arc->mapcc = cc;
+
+   for (ii = cc - 22; ii >= 0 && ii > cc - 22 - 65536; ii--) {                   //  end of central directory,
+      pp = arc->map + ii;                                                        //    before comment < 64 KB
+      if (pp[0] == 'P' && pp[1] == 'K' && pp[2] == 5 && pp[3] == 6) break;
+   }
+   if (ii < 0 || ii <= cc - 22 - 65536) return 0;
+   eocd = arc->map + ii;
+
+   arc->Nleft = zip16(eocd+10);
+   cdcc = zip32(eocd+12);
+   cdpos = zip32(eocd+16);
+
+   if (arc->Nleft == 0xffff || cdcc == 0xffffffff || cdpos == 0xffffffff) {     //  zip64 locator, record
+      if (ii < 20) return 0;
+      pp = eocd - 20;
+      if (zip32(pp) != 0x07064b50) return 0;
+      loc = zip64(pp+8);
+      if (loc < 0 || loc + 56 > cc) return 0;
+      pp = arc->map + loc;
+      if (zip32(pp) != 0x06064b50) return 0;
+      arc->Nleft = zip64(pp+32);
+      cdcc = zip64(pp+40);
+      cdpos = zip64(pp+48);
+   }
+
+   if (cdpos < 0 || cdcc < 0 || cdpos + cdcc > cc) return 0;
+   arc->cdpos = cdpos;
+   arc->cdend = cdpos + cdcc;
+   return 1;
+}
+
+
+//  zip: next central directory entry for a stored or deflated file
+
+cchar * arc_names::zip_next(arcfile *arc)
+{
+   cchar       *pp, *pe, *pend, *name, *extra, *lh;
+   uint        flags, method, dtime, ddate, ncc, ecc, ccc, id, idcc;
+   int64       csize, usize, loff, data;
+   struct tm   tm;
+
+   if (arc->gzopen > 0) inflateEnd(&arc->gz);                                    //  prior member
+   arc->gzopen = 0;
+
+   while (arc->Nleft > 0 && arc->cdpos + 46 <= arc->cdend)
+   {
+      pp = arc->map + arc->cdpos;
+      if (zip32(pp) != 0x02014b50) break;
+
+      flags = zip16(pp+8);
+      method = zip16(pp+10);
+      dtime = zip16(pp+12);
+      ddate = zip16(pp+14);
+      csize = zip32(pp+20);
+      usize = zip32(pp+24);
+      ncc = zip16(pp+28);
+      ecc = zip16(pp+30);
+      ccc = zip16(pp+32);
+      loff = zip32(pp+42);
+      name = pp + 46;
+      extra = name + ncc;
+
+      arc->cdpos += 46 + ncc + ecc + ccc;
+      arc->Nleft--;
+      if (arc->cdpos > arc->cdend) break;
+
+      for (pp = extra; pp + 4 <= extra + ecc; pp += 4 + idcc) {                  //  zip64 extra field: sizes and
+         id = zip16(pp);                                                         //    offset that do not fit 32 bits
+         idcc = zip16(pp+2);
+         pend = pp + 4 + idcc;
+         if (pend > extra + ecc) break;                                          //  record past the extra field
+         if (id != 1) continue;
+         pe = pp + 4;
+         if (usize == 0xffffffff && pe + 8 <= pend) { usize = zip64(pe); pe += 8; }
+         if (csize == 0xffffffff && pe + 8 <= pend) { csize = zip64(pe); pe += 8; }
+         if (loff == 0xffffffff && pe + 8 <= pend) loff = zip64(pe);
+      }
+
+      if (flags & 1) continue;                                                   //  encrypted
+      if (method != 0 && method != 8) continue;                                  //  not stored or deflated
+      if (ncc == 0 || ncc >= XFCC || name[ncc-1] == '/') continue;               //  folder
+
+      if (loff < 0 || loff + 30 > arc->mapcc) continue;                          //  local header, then data
+      lh = arc->map + loff;
+      if (zip32(lh) != 0x04034b50) continue;
+      data = loff + 30 + zip16(lh+26) + zip16(lh+28);
+      if (csize < 0 || data + csize > arc->mapcc) continue;
+
+      memcpy(arc->name,name,ncc);
+      arc->name[ncc] = 0;
+      arc->method = method;
+      arc->zdata = arc->map + data;
+      arc->zcc = csize;
+      arc->zpos = 0;
+      arc->mcc = usize;
+      arc->mread = 0;
+
+      memset(&tm,0,sizeof(tm));                                                  //  DOS date and time, local
+      tm.tm_year = (ddate >> 9) + 80;
+      tm.tm_mon = ((ddate >> 5) & 15) - 1;
+      tm.tm_mday = ddate & 31;
+      tm.tm_hour = dtime >> 11;
+      tm.tm_min = (dtime >> 5) & 63;
+      tm.tm_sec = (dtime & 31) * 2;
+      tm.tm_isdst = -1;
+      arc->mtime = mktime(&tm);
+
+      return arc->name;
+   }
+
+   if (arc->Nleft > 0) arc->error = 1;                                           //  central directory damaged
+   return 0;
+}
+
+
+//  file records reader: larger files are mapped, others are read in blocks.
+//  Records are returned as (offset, length) views into the file data,
+//  without copying. Views of prior records remain valid while their
+//  offset is >= the 'keep' offset passed to recfile_next().
+
+int recfile_open(recfile &rf, cchar *file)                                       //  2.8
+{
+   using namespace arc_names;
+
+   STATB    statf;
+   void     *map;
+   int64    nread;
+   int      type, acc;
+   char     apath[XFCC];
+   cchar    *name = 0;
+   arcfile  *arc;
+
+   memset(&rf,0,sizeof(recfile));
+
+   acc = arc_split(file);                                                        //  archive//member
+   if (acc) {
+      arc = arclisted;                                                           //  member just listed by walker:
+      if (arc && arc->mread == 0 && strmatchN(arc->path,file,acc)                //    read on from archive position
+              && ! arc->path[acc] && strmatch(arc->name,file+acc+2))
+         rf.arc = arc;
+      else {
+         strncpy0(apath,file,acc+1);                                             //  other member (hits list):
+         arc = arc_open(apath,arc_type(apath,acc));                              //    read archive up to member
+         while (arc && (name = arc_next(arc)))
+            if (strmatch(name,file+acc+2)) break;
+         if (arc && ! name) {                                                    //  not found
+            arc_close(arc);
+            arc = 0;
+         }
+         rf.arc = arc;
+         rf.arcown = 1;
+      }
+   }
+
+   if (rf.arc) {
+      rf.fd = -1;
+      rf.cap = recsmall;
+      rf.data = (char *) Zarena_alloc(&Farena,rf.cap);
+      return 0;
+   }
+
+   rf.fd = open(file,O_RDONLY);
+   if (rf.fd < 0) return errno;
+
+   if (fstat(rf.fd,&statf) == 0 && S_ISREG(statf.st_mode)
+                               && statf.st_size > recsmall) {                    //  map larger regular files
+      map = mmap(0,statf.st_size,PROT_READ,MAP_PRIVATE,rf.fd,0);
+      if (map != MAP_FAILED) {
+         madvise(map,statf.st_size,MADV_SEQUENTIAL);
+         type = Funpack ? unpack_type((char *) map,statf.st_size) : 0;
+         if (type) rf.zs = unpack_open(type,-1,(char *) map,statf.st_size);     //  compressed: mapped file is the
+         if (rf.zs) {                                                            //    decompression input
+            rf.zs->map = (char *) map;
+            rf.zs->mapcc = statf.st_size;
+         }
+         else {
+            rf.mapped = 1;
+            rf.data = (char *) map;
+            rf.end = rf.cap = statf.st_size;
+            rf.eof = 1;                                                          //  all data is present
+            return 0;
+         }
+      }
+   }
+
+   rf.cap = recsmall;                                                            //  read small files, pipes etc.
+   rf.data = (char *) Zarena_alloc(&Farena,rf.cap);                              //    in blocks
+
+   if (Funpack && ! rf.zs) {                                                     //  first block, check if compressed
+      do nread = read(rf.fd,rf.data,rf.cap);
+      while (nread < 0 && errno == EINTR);
+      if (nread <= 0) rf.eof = 1;
+      else rf.end = nread;
+      type = unpack_type(rf.data,rf.end);
+      if (type) rf.zs = unpack_open(type,rf.fd,rf.data,rf.end);                  //  input: this block, then fd
+      if (rf.zs) rf.end = rf.eof = 0;
+   }
+
+   return 0;
+}
+
+
+//  read more data after the data present
+//  keep: file offset of oldest data still in use, or -1
+
+void recfile_fill(recfile &rf, int64 keep)                                       //  2.8
+{
+   char     *data2;
+   int64    rcc, nread;
+
+   if (keep < 0 || keep > rf.pos) keep = rf.pos;                                 //  retain views and partial record
+   rcc = rf.end - keep;
+
+   if (rcc == rf.cap) {                                                          //  buffer full, double the size
+      rf.cap *= 2;
+      data2 = (char *) Zarena_alloc(&Farena,rf.cap);                             //  (old buffer freed with arena)
+      memcpy(data2,rf.data + (keep - rf.base),rcc);
+      rf.data = data2;
+   }
+   else if (keep > rf.base)
+      memmove(rf.data,rf.data + (keep - rf.base),rcc);                           //  discard data before 'keep'
+   rf.base = keep;
+
+   do {
+      if (rf.arc) nread = arc_read(rf.arc,rf.data + rcc,rf.cap - rcc);           //  archive member data
+      else if (rf.zs) nread = unpack_read(rf.zs,rf.data + rcc,rf.cap - rcc);     //  decompressed data
+      else nread = read(rf.fd,rf.data + rcc,rf.cap - rcc);
+   } while (nread < 0 && errno == EINTR);
+
+   if (nread <= 0) rf.eof = 1;
+   else rf.end += nread;
+   return;
+}
+
+
+//  get next record, trailing blanks and control characters removed
+//  keep: file offset of oldest record view still in use, or -1
+//  returns 1 and record offset and length, or 0 if no more records
+
+int recfile_next(recfile &rf, int64 keep, int64 &offset, int &cc)                //  2.8
+{
+   char     *pp, *nl;
+   int64    rcc;
+
+   while (true)
+   {
+      pp = rf.data + (rf.pos - rf.base);
+      nl = (char *) memchr(pp,'\n',rf.end - rf.pos);
+      if (nl || rf.eof) break;                                                   //  record complete, or last record
+      recfile_fill(rf,keep);
+   }
+
+   rcc = rf.end - rf.pos;                                                        //  remaining data
+   if (rcc == 0) return 0;
+   if (nl) rcc = nl - pp;                                                        //  record length
+
+   offset = rf.pos;
+   rf.pos += rcc;
+   if (nl) rf.pos++;                                                             //  skip \n
+
+   while (rcc && pp[rcc-1] > 0 && pp[rcc-1] <= ' ') --rcc;                       //  same trim as fgets_trim()
+   cc = rcc;
+   return 1;
+}
+
+
+//  skip records without any of the literal strings: the file data is scanned
+//  for the literals, and records are found only around the hits. The next
+//  recfile_next() gets the first record with a hit.
+//  lits: per file scan state, hit = from = 0 at file start
+//  fold: literals are folded, ignore case
+//  returns 1 if a record has a hit, 0 if no more hits (all data read)
+
+int recfile_skip(recfile &rf, litscan lits[], int nlits, int fold)               //  2.8
+{
+   litscan  *ls;
+   char     *pp, *nl;
+   cchar    *hit;
+   int64    best, from;
+   int      ii;
+
+   while (true)
+   {
+      best = -1;
+
+      for (ii = 0; ii < nlits; ii++)                                             //  next hit of each literal
+      {
+         ls = &lits[ii];
+         if (ls->hit < rf.pos) {                                                 //  none yet, or in a prior record
+            from = (ls->from > rf.pos) ? ls->from : rf.pos;
+            ls->hit = -1;
+            ls->from = from;
+            if (from < rf.end) {
+               hit = zmemmem(rf.data + (from - rf.base),rf.end - from,ls->text,ls->cc,fold);
+               if (hit) ls->hit = rf.base + (hit - rf.data);
+               else if (rf.end - ls->cc + 1 > from)
+                  ls->from = rf.end - ls->cc + 1;                                //  (hit may span the data end)
+            }
+         }
+         if (ls->hit >= 0 && (best < 0 || ls->hit < best)) best = ls->hit;
+      }
+
+      pp = rf.data + (rf.pos - rf.base);
+
+      if (best >= 0) {                                                           //  record of first hit
+         nl = (char *) memrchr(pp,'\n',best - rf.pos);
+         if (nl) rf.pos = rf.base + (nl + 1 - rf.data);
+         return 1;
+      }
+
+      if (rf.eof) {                                                              //  no more hits
+         rf.pos = rf.end;
+         return 0;
+      }
+
+      nl = (char *) memrchr(pp,'\n',rf.end - rf.pos);                            //  skip complete records,
+      if (nl) rf.pos = rf.base + (nl + 1 - rf.data);                             //    read more data
+      recfile_fill(rf,-1);
+   }
+}
+
+
+//  copy record view to buffer with null terminator, enlarge buffer if needed
+
+char * recfile_string(recfile &rf, int64 offset, int cc, char *&buff, int &cap)  //  2.8
+{
+   if (cc >= cap) {
+      cap = cc + 1000;
+      buff = (char *) Zarena_alloc(&Farena,cap);                                 //  (old buffer freed with arena)
+   }
+   memcpy(buff,rf.data + (offset - rf.base),cc);
+   buff[cc] = 0;
+   return buff;
+}
+
+
+void recfile_close(recfile &rf)                                                  //  2.8
+{
+   if (rf.zs) unpack_close(rf.zs);                                               //  stop decompression first
+   rf.zs = 0;
+   if (rf.arc && rf.arcown) arc_close(rf.arc);                                   //  walker's archive stays open
+   rf.arc = 0;
+   if (rf.mapped) munmap(rf.data,rf.end);                                        //  block buffer is freed with arena
+   if (rf.fd >= 0) close(rf.fd);
+   rf.fd = -1;
+   return;
+}
+
+
+//  compressed files: gzip (zlib), xz (liblzma) and zstd (libzstd), found by
+//  their magic bytes. The xz and zstd libraries are loaded at run time if
+//  present, else these files are searched as they are. A worker thread per
+//  file decompresses into a few fixed blocks, which go to the reader through
+//  a queue and come back for reuse, so memory does not grow with file size.
+
+#define xz_run          0                                                        //  liblzma: LZMA_RUN, LZMA_FINISH
+#define xz_finish       3
+#define xz_concatenated 0x08                                                     //  LZMA_CONCATENATED
+#define xz_streamend    1                                                        //  LZMA_STREAM_END
+
+namespace unpack_names
+{
+   pthread_mutex_t   liblock = PTHREAD_MUTEX_INITIALIZER;
+   int      xzlib = 0, zstdlib = 0;                                              //  0 = not loaded, 1 = OK, -1 = missing
+
+   struct xzstream {                                                             //  lzma_stream, liblzma.so.5 ABI
+      const uint8_t  *next_in;
+      size_t         avail_in;
+      uint64_t       total_in;
+      uint8_t        *next_out;
+      size_t         avail_out;
+      uint64_t       total_out;
+      void           *allocator, *internal;
+      void           *reserved_ptr[4];
+      uint64_t       reserved_int1, reserved_int2;
+      size_t         reserved_int3, reserved_int4;
+      int            reserved_enum1, reserved_enum2;
+   };
+
+   int   (*xz_decoder)(xzstream *strm, uint64_t memlimit, uint32_t flags);       //  lzma_stream_decoder()
+   int   (*xz_code)(xzstream *strm, int action);                                 //  lzma_code()
+   void  (*xz_end)(xzstream *strm);                                              //  lzma_end()
+
+   struct zstdbuff {                                                             //  ZSTD_inBuffer, ZSTD_outBuffer
+      void     *buff;
+      size_t   size;
+      size_t   pos;
+   };
+
+   void *   (*zstd_create)();                                                    //  ZSTD_createDCtx()
+   size_t   (*zstd_free)(void *dctx);                                            //  ZSTD_freeDCtx()
+   size_t   (*zstd_stream)(void *dctx, zstdbuff *out, zstdbuff *in);             //  ZSTD_decompressStream()
+   unsigned (*zstd_iserror)(size_t code);                                        //  ZSTD_isError()
+
+   int unpack_libload(int type);
+   void * unpack_thread(void *arg);
+}
+
+
+//  get compressed file type from the first bytes of a file
+//  returns unpack_gzip/xz/zstd or 0 if not compressed
+
+int unpack_type(cchar *data, int64 cc)                                           //  2.8
+{
+   const uchar *dd = (const uchar *) data;
+
+   if (cc >= 3 && dd[0] == 0x1f && dd[1] == 0x8b && dd[2] == 8) return unpack_gzip;
+   if (cc >= 6 && ! memcmp(dd,"\xfd" "7zXZ\0",6)) return unpack_xz;
+   if (cc >= 4 && dd[0] == 0x28 && dd[1] == 0xb5 && dd[2] == 0x2f && dd[3] == 0xfd) return unpack_zstd;
+   return 0;
+}
+
+
+//  load the xz or zstd library if not already done
+//  returns 1 if the library is available
+
+int unpack_names::unpack_libload(int type)
+{
+   void     *lib;
+
+   if (type == unpack_gzip) return 1;                                            //  zlib is linked
+
+   pthread_mutex_lock(&liblock);
+
+   if (type == unpack_xz && ! xzlib) {
+      xzlib = -1;
+      lib = dlopen("liblzma.so.5",RTLD_NOW | RTLD_LOCAL);
+      if (lib) {
+         xz_decoder = (int (*)(xzstream *, uint64_t, uint32_t)) dlsym(lib,"lzma_stream_decoder");
+         xz_code = (int (*)(xzstream *, int)) dlsym(lib,"lzma_code");
+         xz_end = (void (*)(xzstream *)) dlsym(lib,"lzma_end");
+         if (xz_decoder && xz_code && xz_end) xzlib = 1;
+      }
+   }
+
+   if (type == unpack_zstd && ! zstdlib) {
+      zstdlib = -1;
+      lib = dlopen("libzstd.so.1",RTLD_NOW | RTLD_LOCAL);
+      if (lib) {
+         zstd_create = (void * (*)()) dlsym(lib,"ZSTD_createDCtx");
+         zstd_free = (size_t (*)(void *)) dlsym(lib,"ZSTD_freeDCtx");
+         zstd_stream = (size_t (*)(void *, zstdbuff *, zstdbuff *)) dlsym(lib,"ZSTD_decompressStream");
+         zstd_iserror = (unsigned (*)(size_t)) dlsym(lib,"ZSTD_isError");
+         if (zstd_create && zstd_free && zstd_stream && zstd_iserror) zstdlib = 1;
+      }
+   }
+
+   pthread_mutex_unlock(&liblock);
+
+   if (type == unpack_xz) return xzlib > 0;
+   if (type == unpack_zstd) return zstdlib > 0;
+   return 0;
+}
+
+
+//  start decompression of a file
+//  fd: file to read, or -1 if all input is in 'input' (mapped file)
+//  input, incc: input data already read (copied) or mapped (not copied)
+//  returns null if the library for the type is not available
+
+unpack * unpack_open(int type, int fd, cchar *input, int64 incc)                 //  2.8
+{
+   using namespace unpack_names;
+
+   unpack      *zs;
+   unpackblk   *blk;
+
+   if (! unpack_libload(type)) return 0;
+
+   zs = new unpack();                                                            //  zeroed, queues 64 byte aligned
+   zs->type = type;
+   zs->fd = fd;
+   zs->input = input;
+   zs->incc = incc;
+   zs->Nin = incc;
+
+   if (fd >= 0) {                                                                //  input from read(), first part
+      zs->inbuff = (char *) zmalloc(unpackincc > incc ? unpackincc : incc,0);   //    is in caller's buffer
+      memcpy(zs->inbuff,input,incc);
+      zs->input = zs->inbuff;
+   }
+
+   Zqueue_open(&zs->full,unpackblks);
+   Zqueue_open(&zs->empty,unpackblks);
+   for (int ii = 0; ii < unpackblks; ii++) {
+      blk = (unpackblk *) zmalloc(sizeof(unpackblk),0);
+      zs->blocks[ii] = blk;
+      Zqueue_put(&zs->empty,blk);
+   }
+
+   zs->tid = start_Jthread(unpack_thread,zs);
+   return zs;
+}
+
+
+//  decompression worker thread
+//  fills empty blocks and queues them for the reader until the input ends,
+//  the data is found corrupt, or the reader cancels
+
+void * unpack_names::unpack_thread(void *arg)
+{
+   unpack      *zs = (unpack *) arg;
+   unpackblk   *blk = 0;
+   cchar       *in = zs->input;
+   int64       inavail = zs->incc, nread, used, made, space;
+   int         ineof = (zs->fd < 0), finished = 0, err = 0, ret;
+   int         gzend = 0, zframe = 0;                                            //  gzip member, zstd frame ended
+   z_stream    gz;
+   xzstream    xz;
+   void        *zd = 0;
+   zstdbuff    zin, zout;
+   size_t      zret;
+
+   memset(&gz,0,sizeof(gz));
+   memset(&xz,0,sizeof(xz));
+
+   if (zs->type == unpack_gzip)                                                  //  gzip or zlib header
+      err = (inflateInit2(&gz,15+32) != Z_OK);
+   if (zs->type == unpack_xz)
+      err = (xz_decoder(&xz,UINT64_MAX,xz_concatenated) != 0);
+   if (zs->type == unpack_zstd) {
+      zd = zstd_create();
+      err = (zd == 0);
+   }
+
+   while (! err && ! finished)
+   {
+      if (__atomic_load_n(&zs->cancel,__ATOMIC_ACQUIRE)) break;
+
+      if (inavail == 0 && ! ineof) {                                             //  read more input
+         nread = read(zs->fd,zs->inbuff,unpackincc);
+         if (nread < 0 && errno == EINTR) continue;
+         if (nread < 0) { err = 1; break; }
+         if (nread == 0) ineof = 1;
+         in = zs->inbuff;
+         inavail = nread;
+         zs->Nin += nread;
+      }
+
+      if (! blk) {                                                               //  get an empty block
+         blk = (unpackblk *) Zqueue_get(&zs->empty,-1);
+         if (! blk) break;                                                       //  reader cancelled
+         blk->cc = 0;
+      }
+
+      space = unpackcc - blk->cc;
+      used = made = 0;
+
+      if (zs->type == unpack_gzip) {
+         if (gzend && ineof && ! inavail) finished = 1;                          //  last gzip member ended
+         else {
+            gz.next_in = (Bytef *) in;
+            gz.avail_in = inavail;
+            gz.next_out = (Bytef *) blk->data + blk->cc;
+            gz.avail_out = space;
+            ret = inflate(&gz,Z_NO_FLUSH);
+            used = inavail - gz.avail_in;
+            made = space - gz.avail_out;
+            if (ret == Z_STREAM_END) {                                           //  end of gzip member, more members
+               inflateReset(&gz);                                                //    may follow (concatenated files)
+               gzend = 1;
+            }
+            else if (ret != Z_OK && ret != Z_BUF_ERROR) err = 1;
+            else if (ineof && inavail == used && ! made) err = 1;                //  truncated
+            else if (used) gzend = 0;
+         }
+      }
+
+      if (zs->type == unpack_xz) {
+         xz.next_in = (const uint8_t *) in;
+         xz.avail_in = inavail;
+         xz.next_out = (uint8_t *) blk->data + blk->cc;
+         xz.avail_out = space;
+         ret = xz_code(&xz,ineof ? xz_finish : xz_run);
+         used = inavail - xz.avail_in;
+         made = space - xz.avail_out;
+         if (ret == xz_streamend) finished = 1;
+         else if (ret != 0) err = 1;                                             //  corrupt or truncated
+      }
+
+      if (zs->type == unpack_zstd) {
+         zin.buff = (void *) in;
+         zin.size = inavail;
+         zin.pos = 0;
+         zout.buff = blk->data + blk->cc;
+         zout.size = space;
+         zout.pos = 0;
+         zret = zstd_stream(zd,&zout,&zin);
+         used = zin.pos;
+         made = zout.pos;
+         if (zstd_iserror(zret)) err = 1;
+         else {
+            if (used || made) zframe = (zret == 0);                              //  frame complete
+            if (ineof && inavail == used && made < space) {                      //  all input, output not limited
+               if (zframe) finished = 1;
+               else if (! made) err = 1;                                         //  truncated
+            }
+         }
+      }
+
+      in += used;
+      inavail -= used;
+      blk->cc += made;
+
+      if (blk->cc == unpackcc || finished || err) {                              //  block full or last block
+         if (blk->cc) Zqueue_put(&zs->full,blk);
+         else Zqueue_put(&zs->empty,blk);
+         blk = 0;
+      }
+   }
+
+   if (blk) Zqueue_put(&zs->empty,blk);
+
+   if (zs->type == unpack_gzip) inflateEnd(&gz);
+   if (zs->type == unpack_xz) xz_end(&xz);
+   if (zd) zstd_free(zd);
+
+   zs->error = err;
+   Zqueue_done(&zs->full);                                                       //  reader gets null at the end
+   return 0;
+}
+
+
+//  read decompressed data, up to cc bytes
+//  returns bytes read, 0 at the end of the data
+
+int64 unpack_read(unpack *zs, char *buff, int64 cc)                              //  2.8
+{
+   int64    nn;
+
+   while (true)
+   {
+      if (zs->curr) {
+         nn = zs->curr->cc - zs->currpos;                                        //  data left in current block
+         if (nn > 0) {
+            if (nn > cc) nn = cc;
+            memcpy(buff,zs->curr->data + zs->currpos,nn);
+            zs->currpos += nn;
+            return nn;
+         }
+         Zqueue_put(&zs->empty,zs->curr);                                        //  block done, back to worker
+         zs->curr = 0;
+      }
+
+      if (zs->done) return 0;
+      zs->curr = (unpackblk *) Zqueue_get(&zs->full,-1);                         //  wait for next block
+      zs->currpos = 0;
+      if (! zs->curr) zs->done = 1;                                              //  no more
+   }
+}
+
+
+//  stop decompression (if not done) and free all memory
+
+void unpack_close(unpack *zs)                                                    //  2.8
+{
+   __atomic_store_n(&zs->cancel,1,__ATOMIC_RELEASE);
+   Zqueue_done(&zs->empty);                                                      //  wake worker waiting for a block
+   wait_Jthread(zs->tid);
+
+   for (int ii = 0; ii < unpackblks; ii++) zfree(zs->blocks[ii]);
+   Zqueue_close(&zs->full);
+   Zqueue_close(&zs->empty);
+   if (zs->map) munmap(zs->map,zs->mapcc);
+   if (zs->inbuff) zfree(zs->inbuff);
+   delete zs;
+   return;
+}
+
+
+//  file search function - search all file records for search and ignore string(s)
+
+int filesearch(cchar *filename)
+{
+   void recsearch(char *buff,                                                    //  record to search                   1.5
+                  int Rmatch[], int nsrs,                                        //  search strings matched
+                  int Rignore[], int nigs,                                       //  ignore strings matched
+                  int &recmatch, int &recignore);                                //  returned total counts
+
+   int      Fmatch[Smax], Fignore[Smax];                                         //  search and ignore strings in file
+   int      Rmatch[Smax], Rignore[Smax];                                         //  search and ignore strings in record
+   int      filematch, recmatch, recignore, ignored = 0, nrecs = 0, parallel;
+   char     buff[1000], *pp, *linebuff = 0, *ctxbuff = 0;
+   int      ii, jj, cc, Nline, Nlistfoll = 0, linecap = 0, ctxcap = 0;
+   int      line, spans[100][2], nspans;
+   int64    offset;
+   double   time0 = 0;
+   recfile  rf;
+   recview  *ring;                                                               //  preceding records, circular        2.8
+   int      rfirst, rcount;                                                      //  oldest entry, entry count
+
+   Fstopped = 0;
+
+   if (nsrs == 0 && nigs == 0) {                                                 //  no search or ignore strings (matches)
+      log_append2(0," %s \n",filename);                                          //  output file name with no record counts
+      if (outformat) out_file(filename,0);                                       //  2.8
+      return 1;
+   }
+
+   Zarena_reset(&Farena);                                                        //  free prior file buffers            2.8
+   if (++memogen == 0) {                                                         //  new token match cache
+      if (memo) memset(memo,0,memoslots * sizeof(tokmemo));                      //    (generation wrap)
+      memogen = 1;
+   }
+
+   if (Fstats) time0 = get_seconds();                                            //  2.8
+
+   ii = recfile_open(rf,filename);                                               //  open file
+   if (Fstats) stats.Tread += get_seconds() - time0;                             //  open/read time
+   if (ii) {
+      if (Fstats) stats.Xopen++;
+      return 0;
+   }
+
+   for (ii = 0; ii < Smax; ii++) Fmatch[ii] = Fignore[ii] = 0;                   //  no strings found in file yet
+   filematch = 0;
+
+   for (ii = 0; ii < nlits; ii++)                                                //  literal scan from file start
+      literals[ii].hit = literals[ii].from = 0;
+
+   parallel = parfile_use(rf);                                                   //  large file: chunks in parallel     2.8
+   if (parallel) filematch = parfile_search(rf,Fmatch,Fignore,ignored);
+
+   while (! parallel)
+   {
+      if (Fstats) time0 = get_seconds();
+      ii = 1;
+      if (Fliteral) ii = recfile_skip(rf,literals,nlits,FignorecaseS);           //  skip records without literals      2.8
+      if (ii && Fliteral && rf.eof && matchrule == match_all) {                  //  a search string not found yet,
+         for (jj = 0; jj < nsrs; jj++)                                           //    and its literal is not in the
+            if (! Fmatch[jj] && literals[jj].hit < 0) break;                     //      rest of the file: no match
+         if (jj < nsrs) {
+            if (Fstats) stats.Nfstop++;
+            filematch = ii = 0;
+         }
+      }
+      if (ii && Ffiles && filematch &&                                           //  file names only: file is found,
+          filesearch_done(Fmatch,Fignore,rf,Fliteral)) {                         //    rest of file need not be read
+         if (Fstats) stats.Nfstop++;
+         ii = 0;
+      }
+      if (ii) ii = recfile_next(rf,-1,offset,cc);                                //  read next record
+      if (ii) pp = recfile_string(rf,offset,cc,linebuff,linecap);
+      if (Fstats) {
+         stats.Tread += get_seconds() - time0;                                   //  open/read time
+         if (ii) stats.Nrecs++;
+      }
+      if (! ii) break;
+      if (killsearch) {
+         Fstopped = 1;
+         break;
+      }
+
+      if (Tfiledeadline && (++nrecs & 1023) == 0 &&                              //  search time is up                  2.8
+          get_seconds() > Tfiledeadline) {
+         Flimit = limit_deadline;
+         Fstopped = 1;
+         break;
+      }
+
+      recsearch(pp,Rmatch,nsrs,Rignore,nigs,recmatch,recignore);                 //  search for match and ignore strings
+
+      if (recmatch + recignore == 0) continue;                                   //  record has no matches, ignore
+
+      if (nigs > 0) {
+         if (ignorerule == ignore_any && recignore > 0) {
+            filematch = 0;                                                       //  reject if any ignore string in record
+            ignored = 1;
+            if (Fstats) stats.Nfstop++;
+            break;
+         }
+
+         if (ignorerule == ignore_rec_all && recignore == nigs) {
+            filematch = 0;                                                       //  reject if all ignore strings in record
+            ignored = 1;
+            if (Fstats) stats.Nfstop++;
+            break;
+         }
+      }
+
+      if (recmatch > 0) {
+         if (matchrule == match_rec_all && recmatch < nsrs) recmatch = 0;        //  ignore record without all match strings
+         if (recignore > 0) {
+            if (ignorerule == ignore_match_any) recmatch = 0;                    //  ignore record with any ignore string
+            if (ignorerule == ignore_match_all)
+                if (recignore == nigs) recmatch = 0;                             //  ignore record with all ignore strings
+         }
+      }
+
+      if (recmatch > 0) {
+         filematch += recmatch;                                                  //  find matches for entire file
+         for (ii = 0; ii < nsrs; ii++) Fmatch[ii] += Rmatch[ii];
+      }
+
+      if (recignore > 0)                                                         //  ignore matches for entire file
+         for (ii = 0; ii < nigs; ii++) Fignore[ii] += Rignore[ii];
+
+      if (recignore > 0 && ignorerule == ignore_all) {                           //  all ignore strings found in file:
+         for (ii = 0; ii < nigs; ii++) if (Fignore[ii] == 0) break;              //    reject now                       2.8
+         if (ii == nigs) {
+            filematch = 0;
+            ignored = 1;
+            if (Fstats) stats.Nfstop++;
+            break;
+         }
+      }
+   }
+
+   if (Fstats) {
+      stats.Nsearch++;                                                           //  files and bytes searched
+      stats.Nbytes += rf.end;
+      if (rf.zs) {                                                               //  compressed file
+         stats.Nunpack++;
+         stats.Nzbytes += rf.zs->Nin;
+         if (rf.zs->done && rf.zs->error) stats.Xunpack++;
+      }
+   }
+
+   if (Fstats) time0 = get_seconds();
+   recfile_close(rf);
+   if (Fstats) stats.Tread += get_seconds() - time0;
+
+   if (Fstopped || (killsearch && ! Fbatch)) return 0;                           //  file not done
+
+   if (filematch == 0) {                                                         //  reject file with no match strings
+      if (Fstats && ignored) stats.Xignore++;
+      else if (Fstats) stats.Xnomatch++;
+      return 0;
+   }
+
+   if (ignorerule == ignore_all && nigs > 0) {
+      for (ii = 0; ii < nigs; ii++) if (Fignore[ii] == 0) break;                 //  reject files with all ignore strings
+      if (ii == nigs) {
+         if (Fstats) stats.Xignore++;
+         return 0;
+      }
+   }
+
+   if (matchrule == match_all) {
+      for (ii = 0; ii < nsrs; ii++) if (Fmatch[ii] == 0) break;                  //  reject files without all match strings
+      if (ii < nsrs) {
+         if (Fstats) stats.Xnomatch++;
+         return 0;
+      }
+   }
+
+   if (! listmatch && Ffiles) {                                                  //  output file name only              2.8
+      log_append2(0," %s \n",filename);
+      if (outformat) out_file(filename,filematch);
+      return filematch;
+   }
+
+   if (! listmatch) {
+      log_append2(0," %5d %s \n",filematch,filename);                            //  output match count and file name
+      if (outformat) out_file(filename,filematch);                               //  2.8
+      return filematch;
+   }
+
+   //  file is selected and detail is wanted, read again to list matching records
+
+   snprintf(buff,999,"\n %s \n",filename);                                       //  output file name in bold
+   log_append2(1,"%s",buff);
+
+   if (Fstats) time0 = get_seconds();
+   ii = recfile_open(rf,filename);                                               //  open file
+   if (Fstats) stats.Tread += get_seconds() - time0;
+   if (ii) return 0;
+
+   if (parfile_use(rf)) {                                                        //  large file: chunks in parallel     2.8
+      filematch += parfile_list(rf,filename);
+      recfile_close(rf);
+      return filematch;
+   }
+
+   Nline = 0;                                                                    //  track line numbers                 2.0
+
+   ring = (recview *) Zarena_alloc(&Farena,(listprec + 1) * sizeof(recview));   //  preceding records, empty           2.8
+   rfirst = rcount = 0;
+
+   while (true)
+   {
+      if (killsearch && ! Fbatch) break;                                         //  (batch: list all, file is done)
+
+      if (Fstats) time0 = get_seconds();
+      ii = recfile_next(rf,rcount ? ring[rfirst].offset : -1,offset,cc);        //  read next record, keep preceding
+      if (ii) pp = recfile_string(rf,offset,cc,linebuff,linecap);
+      if (Fstats) stats.Tread += get_seconds() - time0;                          //  2.8
+      if (! ii) break;
+
+      Nline++;                                                                   //  track line numbers                 2.0
+
+      recsearch(pp,Rmatch,nsrs,Rignore,nigs,recmatch,recignore);                 //  search for match and ignore strings
+
+      if (recmatch > 0) {
+         if (matchrule == match_rec_all && recmatch < nsrs) recmatch = 0;        //  ignore record without all match strings
+         if (recignore > 0) {
+            if (ignorerule == ignore_match_any) recmatch = 0;                    //  ignore record with any ignore string
+            if (ignorerule == ignore_match_all)
+                if (recignore == nigs) recmatch = 0;                             //  ignore record with all ignore strings
+         }
+      }
+
+      if (recmatch) {                                                            //  this record is a match
+         filematch += recmatch;                                                  //  accumulate matches for entire file
+         for (ii = 0; ii < nsrs; ii++) Fmatch[ii] += Rmatch[ii];
+         for (ii = 0; ii < nigs; ii++) Fignore[ii] += Rignore[ii];
+         Nlistfoll = listfoll;                                                   //  set following records to list      2.1
+      }
+
+      if (recmatch) {                                                            //  print preceding records            1.5
+         for (ii = 0; ii < rcount; ii++) {                                       //    oldest first
+            jj = rfirst + ii;
+            if (jj >= listprec) jj -= listprec;
+            recfile_string(rf,ring[jj].offset,ring[jj].cc,ctxbuff,ctxcap);
+            log_append2(0,"%5d  %s \n",ring[jj].line,ctxbuff);
+            if (outformat) out_record(filename,ring[jj].line,ctxbuff,0);        //  2.8
+         }
+         rfirst = rcount = 0;                                                    //  clear preceding records
+      }
+
+      if (recmatch)
+      {
+         log_append2(0,"%5d  %s \n",Nline,pp);                                   //  print matching record              2.5
+         if (outformat) out_record(filename,Nline,pp,1);                         //  2.8
+
+         if (Fstats) time0 = get_seconds();
+
+         if (! Fbatch) {                                                         //  GUI only                           2.8
+            nspans = recspans(pp,spans,100);                                     //  get matching strings in record
+            line = textwidget_linecount(mLog) - 2;                               //  text report line
+            for (ii = 0; ii < nspans; ii++)                                      //  make strings bold
+               textwidget_bold_word(mLog,line,spans[ii][0]+7,spans[ii][1]-spans[ii][0]);
+         }
+
+         if (Fstats) stats.Tout += get_seconds() - time0;                        //  output time
+      }
+
+      if (recmatch && listprec > 0 && ! listfoll)                                //  add a spacer line if no following  2.1
+         log_append2(0,"\n");                                                    //    records are to be listed
+
+      if (! recmatch && Nlistfoll > 0) {
+         log_append2(0,"%5d  %s \n",Nline,pp);                                   //  list records following match       2.1
+         if (outformat) out_record(filename,Nline,pp,0);                         //  2.8
+         Nlistfoll--;
+         if (Nlistfoll == 0) log_append2(0,"\n");                                //  add a spacer line after following  2.1
+      }                                                                          //    records are listed
+
+      else if (! recmatch && listprec > 0) {                                     //  save unlisted record view          2.8
+         if (rcount == listprec) {                                               //  full, discard oldest
+            if (++rfirst == listprec) rfirst = 0;
+            rcount--;
+         }
+         jj = rfirst + rcount;
+         if (jj >= listprec) jj -= listprec;
+         ring[jj].offset = offset;
+         ring[jj].cc = cc;
+         ring[jj].line = Nline;
+         rcount++;
+      }
+   }
+
+   recfile_close(rf);
+   return filematch;                                                             //  buffers are freed with arena
+}
+
+
+/**
+ * @brief filesearch_done - for file names only (Ffiles): test if a file with matches
+ *        found so far is found also if the rest of the file is not read.
+ *        The file ignore rules (ignore any, all, all in record) need the literal
+ *        scan to show that ignore strings are not in the rest of the file.
+ * @param Fmatch     search strings in matching records so far
+ * @param Fignore    ignore strings so far
+ * @param rf         file being read
+ * @param scanned    recfile_skip() is done for the rest of the file
+ * @return 1 if the file is found
+ */
+int filesearch_done(int Fmatch[], int Fignore[], recfile &rf, int scanned)       //  2.8
+{
+   int      ii, absent;
+
+   if (matchrule == match_all)                                                   //  all search strings needed
+      for (ii = 0; ii < nsrs; ii++) if (! Fmatch[ii]) return 0;
+
+   if (nigs == 0) return 1;                                                      //  record ignore rules were applied
+   if (ignorerule == ignore_match_any || ignorerule == ignore_match_all) return 1;
+
+   if (! scanned || ! rf.eof) return 0;                                          //  ignore strings may follow
+
+   for (ii = 0; ii < nigs; ii++)
+   {
+      absent = (literals[nsrs+ii].hit < 0);                                      //  not in rest of file
+      if (ignorerule == ignore_any && ! absent) return 0;                        //  any: all must be absent
+      if (ignorerule == ignore_rec_all && absent) return 1;                      //  all in record: one absent
+      if (ignorerule == ignore_all && absent && ! Fignore[ii]) return 1;         //  all: one absent and not found
+   }
+
+   return (ignorerule == ignore_any);
+}
+
+
+//  usable CPUs: the CPUs the process may run on (affinity), or fewer if the
+//  CPU quota of its cgroup or a cgroup above is lower (containers)
+//  quota: the lowest quota in CPUs, 0 = none
+
+int cpu_count(double &quota)                                                     //  2.8
+{
+   cpu_set_t   cpuset;
+   FILE        *fid;
+   char        line[XFCC], path[XFCC], file[XFCC+40], *pp;
+   double      max, period;
+   int         cpus;
+
+   cpus = get_nprocs();
+   if (sched_getaffinity(0,sizeof(cpuset),&cpuset) == 0) cpus = CPU_COUNT(&cpuset);
+   quota = 0;
+
+   *path = 0;                                                                    //  cgroup v2: "0::/path"
+   fid = fopen("/proc/self/cgroup","r");
+   if (fid) {
+      while (fgets(line,XFCC,fid))
+      {
+         if (strncmp(line,"0::",3)) continue;
+         strncpy0(path,line+3,XFCC);
+         pp = strchr(path,'\n');
+         if (pp) *pp = 0;
+      }
+      fclose(fid);
+   }
+
+   while (true)                                                                  //  cpu.max of cgroup and those above:
+   {                                                                             //    "quota period" or "max period"
+      snprintf(file,sizeof(file),"/sys/fs/cgroup%s/cpu.max",path);
+      fid = fopen(file,"r");
+      if (fid) {
+         if (fscanf(fid,"%lf %lf",&max,&period) == 2 && max > 0 && period > 0)
+            if (! quota || max / period < quota) quota = max / period;
+         fclose(fid);
+      }
+      pp = strrchr(path,'/');
+      if (! pp) break;
+      *pp = 0;
+   }
+
+   fid = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us","r");                       //  cgroup v1, -1 = none
+   if (fid) {
+      if (fscanf(fid,"%lf",&max) != 1) max = -1;
+      fclose(fid);
+      fid = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us","r");
+      if (fid) {
+         if (fscanf(fid,"%lf",&period) == 1 && max > 0 && period > 0)
+            if (! quota || max / period < quota) quota = max / period;
+         fclose(fid);
+      }
+   }
+
+   if (quota > 0 && quota < cpus) cpus = quota;                                  //  whole CPUs of the quota
+   if (cpus < 1) cpus = 1;
+   return cpus;
+}
+
+
+//  set the large file concurrency for the file system of the search root:
+//    memory (tmpfs): CPU bound, a worker per CPU, no chunks read ahead
+//    local SSD: a worker per CPU, 2 chunks read ahead
+//    local disk (rotational): 2 workers, as seeks between chunks are slow,
+//      4 chunks read ahead
+//    network (NFS, SMB, FUSE ...): a worker per CPU, up to 2 per CPU to
+//      cover the I/O latency, 4 chunks read ahead
+//  --file-threads N sets the workers, not adjusted.
+//  The workers and chunks read ahead are adjusted as large files are
+//  searched, see fstune_adjust().
+
+void fstune_open(cchar *path)                                                    //  2.8
+{
+   static struct { uint magic; cchar *name; int kind; } fstypes[] = {
+      { 0x01021994, "tmpfs", fs_memory },     { 0x858458F6, "ramfs", fs_memory },
+      { 0x00006969, "nfs", fs_network },      { 0x0000517B, "smb", fs_network },
+      { 0xFF534D42, "cifs", fs_network },     { 0xFE534D42, "smb2", fs_network },
+      { 0x65735546, "fuse", fs_network },     { 0x01021997, "9p", fs_network },
+      { 0x00C36400, "ceph", fs_network },     { 0x5346414F, "afs", fs_network },
+      { 0x0000EF53, "ext4", fs_ssd },         { 0x58465342, "xfs", fs_ssd },
+      { 0x9123683E, "btrfs", fs_ssd },        { 0x2FC12FC1, "zfs", fs_ssd },
+      { 0xF2F52010, "f2fs", fs_ssd },         { 0x794C7630, "overlay", fs_ssd },
+      { 0x00004D44, "vfat", fs_ssd },         { 0x2011BAB0, "exfat", fs_ssd },
+      { 0x5346544E, "ntfs", fs_ssd },         { 0x73717368, "squashfs", fs_ssd },
+      { 0x00009660, "iso9660", fs_ssd } };
+
+   struct statfs  fsb;
+   STATB    statb;
+   FILE     *fid;
+   char     root[XFCC], file[100], *pp;
+   uint     magic;
+   int      ii, rot = 0;
+
+   strncpy0(root,path,XFCC);                                                     //  root: path before wildcards
+   pp = strpbrk(root,"*?");
+   if (pp) *pp = 0;
+
+   while (statfs(root,&fsb) != 0)                                                //  root folder, or nearest above
+   {
+      pp = strrchr(root,'/');
+      if (! pp) break;
+      if (pp == root) pp++;
+      if (! *pp) break;
+      *pp = 0;
+   }
+
+   memset(&tune,0,sizeof(tune));
+   magic = (*root && statfs(root,&fsb) == 0) ? uint(fsb.f_type) : 0;
+   tune.kind = fs_ssd;                                                           //  unknown: local
+   snprintf(tune.fsname,20,"0x%x",magic);
+   for (ii = 0; ii < int(sizeof(fstypes) / sizeof(fstypes[0])); ii++)
+      if (fstypes[ii].magic == magic) {
+         strcpy(tune.fsname,fstypes[ii].name);
+         tune.kind = fstypes[ii].kind;
+      }
+
+   if (tune.kind == fs_ssd && stat(root,&statb) == 0) {                          //  local: rotational device?
+      snprintf(file,100,"/sys/dev/block/%u:%u/queue/rotational",                 //    (partition: of its disk)
+                        major(statb.st_dev),minor(statb.st_dev));
+      fid = fopen(file,"r");
+      if (! fid) {
+         snprintf(file,100,"/sys/dev/block/%u:%u/../queue/rotational",
+                           major(statb.st_dev),minor(statb.st_dev));
+         fid = fopen(file,"r");
+      }
+      if (fid) {
+         if (fscanf(fid,"%d",&rot) != 1) rot = 0;
+         fclose(fid);
+      }
+      if (rot) tune.kind = fs_disk;
+   }
+
+   tune.cpus = cpu_count(tune.quota);
+   tune.maxthreads = tune.threads0 = tune.cpus;
+   tune.depth0 = 2;
+   if (tune.kind == fs_memory) tune.depth0 = 0;
+   if (tune.kind == fs_disk) {
+      if (tune.threads0 > 2) tune.threads0 = 2;
+      tune.depth0 = 4;
+   }
+   if (tune.kind == fs_network) {
+      tune.maxthreads = 2 * tune.cpus;
+      tune.depth0 = 4;
+   }
+
+   if (filethreads > 0) {                                                        //  --file-threads N
+      tune.fixed = 1;
+      tune.maxthreads = tune.threads0 = filethreads;
+   }
+
+   if (tune.maxthreads > parmax) tune.maxthreads = parmax;
+   if (tune.threads0 > tune.maxthreads) tune.threads0 = tune.maxthreads;
+   tune.threads = tune.threads0;
+   tune.depth = tune.depth0;
+   return;
+}
+
+
+//  adjust the large file concurrency after a round of chunks (AIMD):
+//  one more worker while the throughput holds, half the workers if it
+//  drops by more than 10 %. One more chunk is read ahead while the workers
+//  wait for I/O (elapsed time 1.5 x their CPU time or more, more if there
+//  are more workers than CPUs), half as many if they do not (1.1 x or less).
+//  rate: bytes/sec of the round, Twork, Tcpu: worker elapsed and CPU secs
+
+void fstune_adjust(double rate, double Twork, double Tcpu)                       //  2.8
+{
+   double   share = 1;                                                           //  CPU share of a worker
+
+   tune.Nrounds++;
+
+   if (tune.threads > tune.cpus) share = double(tune.cpus) / tune.threads;
+   Tcpu = Tcpu / share;                                                          //  elapsed time without I/O waits
+
+   if (Tcpu > 0) {
+      if (Twork >= 1.5 * Tcpu) {
+         if (tune.depth < fsaheadmax) tune.depth++;
+      }
+      else if (Twork <= 1.1 * Tcpu) tune.depth /= 2;
+   }
+
+   if (! tune.fixed && tune.rate > 0) {                                          //  (not the first round of a file)
+      if (rate >= 0.9 * tune.rate) {
+         if (tune.threads < tune.maxthreads) {
+            tune.threads++;
+            tune.Nup++;
+         }
+      }
+      else if (tune.threads > 1) {
+         tune.threads = (tune.threads + 1) / 2;
+         tune.Ndown++;
+      }
+   }
+
+   tune.rate = rate;
+   return;
+}
+
+
+//  large files: a mapped file of parfilecc or more is split into chunks that
+//  end after a record, and worker threads search the chunks. Pass 1 finds the
+//  search and ignore strings per chunk, which are summed for the file rules
+//  (an ignore string that rejects the file stops all workers). Pass 2 lists
+//  the matching records: the workers return the matches of a chunk with line
+//  numbers from the chunk start, and the chunks are output in file order, with
+//  the line counts of the prior chunks added (workers stay a few chunks ahead).
+//  Preceding and following records are found in the mapped file around the
+//  matches, also across chunk ends. The output is the same as one thread.
+//  The workers searching at once and the chunks read ahead of them are set
+//  per file system and adjusted after each round of chunks (fstune).
+
+namespace parfile_names
+{
+   int64 par_lines(cchar *data, int64 from, int64 to);
+   parfile * par_open(recfile &rf, int pass);
+   void par_queue(parfile *pf, int upto);
+   void par_advise(parfile *pf, int upto);
+   void par_wait(parfile *pf, parchunk *ck);
+   void par_round(parfile *pf, parchunk *ck);
+   double par_cputime();
+   void par_stats(parfile *pf, double Twall);
+   void par_close(parfile *pf);
+   void * par_thread(void *arg);
+   void par_chunk(parfile *pf, parchunk *ck);
+   void par_record(recfile &rv, cchar *filename, int line, int64 offset, int cc,
+                   int match, char *&buff, int &cap);
+   void par_follow(recfile &rv, cchar *filename, int last, int64 next, int upto,
+                   char *&buff, int &cap);
+   void par_precede(recfile &rv, cchar *filename, int last, int64 offset, int line,
+                    char *&buff, int &cap);
+}
+
+
+//  test if a file is searched in chunks by several threads:
+//  a mapped file (not compressed) of parfilecc or more,
+//  not for file names only (read up to the first match)
+
+int parfile_use(recfile &rf)                                                     //  2.8
+{
+   if (! rf.mapped || rf.end < parfilecc || Ffiles) return 0;
+   return (tune.maxthreads > 1);
+}
+
+
+//  pass 1: search all chunks, sum the strings found
+//  returns the matches in the file, 0 if rejected by an ignore string
+//  Fstopped and Flimit are set if stopped by kill or deadline
+
+int parfile_search(recfile &rf, int Fmatch[], int Fignore[], int &ignored)       //  2.8
+{
+   using namespace parfile_names;
+
+   parfile  *pf;
+   parchunk *ck;
+   int      ii, kk, filematch = 0, stopped = 0;
+   double   time0 = 0;
+
+   if (Fstats) time0 = get_seconds();
+
+   pf = par_open(rf,1);
+   par_queue(pf,pf->nchunks);                                                    //  all chunks, any order
+   for (kk = 0; kk < pf->nchunks; kk++) {
+      par_wait(pf,&pf->chunks[kk]);
+      par_round(pf,&pf->chunks[kk]);
+   }
+
+   for (kk = 0; kk < pf->nchunks; kk++)
+   {
+      ck = &pf->chunks[kk];
+      if (ck->ignored) ignored = 1;
+      if (ck->stopped > stopped) stopped = ck->stopped;
+      filematch += ck->filematch;
+      for (ii = 0; ii < nsrs; ii++) Fmatch[ii] += ck->Fmatch[ii];
+      for (ii = 0; ii < nigs; ii++) Fignore[ii] += ck->Fignore[ii];
+   }
+
+   if (ignored) {                                                                //  file is rejected, also if
+      filematch = 0;                                                             //    stopped in other chunks
+      if (Fstats) stats.Nfstop++;
+   }
+   else if (stopped) {
+      Fstopped = 1;
+      if (stopped == 2) Flimit = limit_deadline;
+   }
+
+   if (Fstats) par_stats(pf,get_seconds() - time0);
+   par_close(pf);
+   return filematch;
+}
+
+
+//  pass 2: list the matching records with preceding and following records
+//  returns the count of matches listed
+
+int parfile_list(recfile &rf, cchar *filename)                                   //  2.8
+{
+   using namespace parfile_names;
+
+   parfile  *pf;
+   parchunk *ck;
+   parmatch *pm;
+   recfile  rv;
+   char     *buff = 0;
+   int      ii, kk, cc, window, cap = 0, filematch = 0;
+   int      base = 0, line, last = 0;                                            //  lines of prior chunks, last match
+   int64    offset, next = 0;                                                    //  record after last match
+   double   time0 = 0;
+
+   if (Fstats) time0 = get_seconds();
+
+   pf = par_open(rf,2);
+   window = 2 * pf->nthreads;                                                    //  chunks searched ahead of output
+   par_queue(pf,window);
+
+   rv = rf;                                                                      //  records view of the mapped file
+
+   for (kk = 0; kk < pf->nchunks; kk++)
+   {
+      ck = &pf->chunks[kk];
+      par_wait(pf,ck);
+      par_round(pf,ck);
+      par_queue(pf,kk + 1 + window);
+
+      for (ii = 0; ii < ck->nmatch; ii++)
+      {
+         if (killsearch && ! Fbatch) break;                                      //  (batch: list all, file is done)
+         pm = &ck->matches[ii];
+         line = base + pm->line;
+         if (last) par_follow(rv,filename,last,next,line,buff,cap);              //  following prior match
+         par_precede(rv,filename,last,pm->offset,line,buff,cap);                 //  preceding this match
+         par_record(rv,filename,line,pm->offset,pm->cc,1,buff,cap);
+         if (listprec > 0 && ! listfoll) log_append2(0,"\n");                    //  spacer if no following records
+         last = line;
+         rv.pos = pm->offset;
+         recfile_next(rv,-1,offset,cc);
+         next = rv.pos;
+      }
+
+      if (ii < ck->nmatch) break;
+      filematch += ck->filematch;
+      base += ck->lines;                                                         //  line numbers of next chunk
+      zfree(ck->matches);
+      ck->matches = 0;
+   }
+
+   if (last && kk == pf->nchunks)                                                //  following last match
+      par_follow(rv,filename,last,next,INT_MAX,buff,cap);
+
+   if (Fstats) par_stats(pf,get_seconds() - time0);
+   par_close(pf);
+   return filematch;                                                             //  buff is freed with arena
+}
+
+
+//  count records ended in file data [from, to)
+
+int64 parfile_names::par_lines(cchar *data, int64 from, int64 to)
+{
+   cchar    *pp = data + from, *end = data + to;
+   int64    nn = 0;
+
+   while ((pp = (cchar *) memchr(pp,'\n',end - pp))) {
+      nn++;
+      pp++;
+   }
+
+   return nn;
+}
+
+
+//  split the file into chunks and start the worker threads
+
+parfile * parfile_names::par_open(recfile &rf, int pass)
+{
+   parfile  *pf;
+   parchunk *ck;
+   cchar    *nl;
+   int64    begin, end;
+   int      ii;
+
+   pf = new parfile();                                                           //  zeroed, queue 64 byte aligned
+   pf->data = rf.data;
+   pf->cc = rf.end;
+   pf->pass = pass;
+   pf->chunks = (parchunk *) zmalloc((rf.end / parchunkcc + 1) * sizeof(parchunk));
+
+   for (begin = 0; begin < rf.end; begin = end)                                  //  chunks of parchunkcc or more,
+   {                                                                             //    ending after a record
+      end = begin + parchunkcc;
+      if (end >= rf.end) end = rf.end;
+      else {
+         nl = (cchar *) memchr(rf.data + end - 1,'\n',rf.end - end + 1);
+         end = nl ? nl + 1 - rf.data : rf.end;
+      }
+      ck = &pf->chunks[pf->nchunks++];
+      ck->begin = begin;
+      ck->end = end;
+   }
+
+   pf->nthreads = tune.maxthreads;                                               //  workers, and those searching
+   if (pf->nthreads > pf->nchunks) pf->nthreads = pf->nchunks;
+   pf->limit = tune.threads;
+   if (pf->limit > pf->nthreads) pf->limit = pf->nthreads;
+   pf->Tround = get_seconds();
+   tune.rate = 0;                                                                //  no prior round of this file
+   par_advise(pf,pf->limit + tune.depth);
+
+   pthread_mutex_init(&pf->lock,0);
+   pthread_cond_init(&pf->cond,0);
+   Zqueue_open(&pf->work,pf->nchunks);
+   for (ii = 0; ii < pf->nthreads; ii++)
+      pf->tids[ii] = start_Jthread(par_thread,pf);
+
+   if (Fstats && pass == 1) {
+      stats.Npfile++;
+      stats.Npchunk += pf->nchunks;
+      if (pf->nthreads > stats.Npthread) stats.Npthread = pf->nthreads;
+   }
+
+   return pf;
+}
+
+
+//  give the chunks before 'upto' to the workers, end the queue after the last
+
+void parfile_names::par_queue(parfile *pf, int upto)
+{
+   if (pf->nqueued == pf->nchunks) return;
+   if (upto > pf->nchunks) upto = pf->nchunks;
+
+   while (pf->nqueued < upto)                                                    //  (queue capacity is all chunks)
+      Zqueue_put(&pf->work,&pf->chunks[pf->nqueued++]);
+
+   if (pf->nqueued == pf->nchunks) Zqueue_done(&pf->work);
+   return;
+}
+
+
+//  read ahead the chunks before 'upto' (not waiting for the page faults)
+
+void parfile_names::par_advise(parfile *pf, int upto)
+{
+   parchunk *ck;
+   int64    page = sysconf(_SC_PAGESIZE), begin;
+
+   if (upto > pf->nchunks) upto = pf->nchunks;
+
+   while (pf->nadvised < upto)
+   {
+      ck = &pf->chunks[pf->nadvised++];
+      begin = ck->begin - ck->begin % page;
+      madvise((void *) (pf->data + begin),ck->end - begin,MADV_WILLNEED);
+   }
+
+   return;
+}
+
+
+//  wait for a worker to finish a chunk
+
+void parfile_names::par_wait(parfile *pf, parchunk *ck)
+{
+   pthread_mutex_lock(&pf->lock);
+   while (! ck->done) pthread_cond_wait(&pf->cond,&pf->lock);
+   pthread_mutex_unlock(&pf->lock);
+   return;
+}
+
+
+//  a chunk is done: read ahead, and after a round of chunks (as many as
+//  workers searching) adjust the workers searching and chunks read ahead
+
+void parfile_names::par_round(parfile *pf, parchunk *ck)
+{
+   double   now, secs;
+
+   if (__atomic_load_n(&pf->stop,__ATOMIC_ACQUIRE)) return;                      //  chunks not searched
+
+   par_advise(pf,ck - pf->chunks + 1 + pf->limit + tune.depth);
+
+   pf->Rchunks++;
+   pf->Rbytes += ck->end - ck->begin;
+   pf->Rwork += ck->Twork;
+   pf->Rcpu += ck->Tcpu;
+   if (pf->Rchunks < pf->limit) return;
+
+   now = get_seconds();
+   secs = now - pf->Tround;
+   if (secs > 0) fstune_adjust(pf->Rbytes / secs,pf->Rwork,pf->Rcpu);
+   pf->Rchunks = 0;
+   pf->Rbytes = 0;
+   pf->Rwork = pf->Rcpu = 0;
+   pf->Tround = now;
+
+   pthread_mutex_lock(&pf->lock);                                                //  workers searching from now
+   pf->limit = tune.threads;
+   if (pf->limit > pf->nthreads) pf->limit = pf->nthreads;
+   pthread_cond_broadcast(&pf->cond);
+   pthread_mutex_unlock(&pf->lock);
+   return;
+}
+
+
+//  CPU time of the calling thread, secs.
+
+double parfile_names::par_cputime()
+{
+   timespec    time1;
+
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID,&time1);
+   return time1.tv_sec + time1.tv_nsec * 0.000000001;
+}
+
+
+//  add the worker counters to the search statistics
+//  the worker times overlap: they are scaled down to the elapsed time
+
+void parfile_names::par_stats(parfile *pf, double Twall)
+{
+   search_stats   *st;
+   double   Tread = 0, Ttoken = 0, Tmatch = 0, Tsum, scale = 1;
+
+   for (int kk = 0; kk < pf->nchunks; kk++)
+   {
+      st = &pf->chunks[kk].st;
+      stats.Nrecs += st->Nrecs;
+      stats.Nmemo += st->Nmemo;
+      stats.Hmemo += st->Hmemo;
+      stats.Nsettle += st->Nsettle;
+      Tread += st->Tread;
+      Ttoken += st->Ttoken;
+      Tmatch += st->Tmatch;
+   }
+
+   Tsum = Tread + Ttoken + Tmatch;
+   if (Tsum > Twall) scale = Twall / Tsum;
+   stats.Tread += Tread * scale;
+   stats.Ttoken += Ttoken * scale;
+   stats.Tmatch += Tmatch * scale;
+   return;
+}
+
+
+//  stop the workers and free memory
+
+void parfile_names::par_close(parfile *pf)
+{
+   int      ii;
+
+   __atomic_store_n(&pf->stop,1,__ATOMIC_RELEASE);                               //  skip chunks not searched
+   par_queue(pf,pf->nchunks);
+   for (ii = 0; ii < pf->nthreads; ii++)
+      wait_Jthread(pf->tids[ii]);
+
+   for (ii = 0; ii < pf->nchunks; ii++)
+      if (pf->chunks[ii].matches) zfree(pf->chunks[ii].matches);
+
+   Zqueue_close(&pf->work);
+   pthread_mutex_destroy(&pf->lock);
+   pthread_cond_destroy(&pf->cond);
+   zfree(pf->chunks);
+   delete pf;
+   return;
+}
+
+
+//  worker thread: search chunks until the queue ends
+
+void * parfile_names::par_thread(void *arg)
+{
+   parfile  *pf = (parfile *) arg;
+   parchunk *ck;
+   double   time0, cpu0;
+
+   while ((ck = (parchunk *) Zqueue_get(&pf->work)))
+   {
+      pthread_mutex_lock(&pf->lock);                                             //  wait while the allowed workers
+      while (pf->active >= pf->limit)                                            //    are searching
+         pthread_cond_wait(&pf->cond,&pf->lock);
+      pf->active++;
+      pthread_mutex_unlock(&pf->lock);
+
+      if (! __atomic_load_n(&pf->stop,__ATOMIC_ACQUIRE)) {
+         time0 = get_seconds();
+         cpu0 = par_cputime();
+         par_chunk(pf,ck);
+         ck->Tcpu = par_cputime() - cpu0;
+         ck->Twork = get_seconds() - time0;
+      }
+
+      pthread_mutex_lock(&pf->lock);
+      pf->active--;
+      ck->done = 1;
+      pthread_cond_broadcast(&pf->cond);
+      pthread_mutex_unlock(&pf->lock);
+   }
+
+   if (memo) zfree(memo);                                                        //  this thread's token match cache
+   memo = 0;
+   return 0;
+}
+
+
+//  search the records of a chunk with the rules of filesearch()
+//  pass 1: strings found, stop all workers if the file is rejected,
+//          or for kill and deadline
+//  pass 2: matching records, line numbers, count of records
+
+void parfile_names::par_chunk(parfile *pf, parchunk *ck)
+{
+   int      Rmatch[Smax], Rignore[Smax];
+   int      ii, cc, more, recmatch, recignore, nrecs = 0, cap = 0;
+   int64    offset, lpos, lnum = 0;                                              //  records ended before lpos
+   char     *buff = 0;
+   double   time0 = 0;
+   recfile  rf;
+   litscan  lits[2*Smax];
+   parmatch *pm;
+
+   rstats = &ck->st;                                                             //  recsearch() counters
+
+   memset(&rf,0,sizeof(recfile));                                                //  view of the chunk, all present
+   rf.fd = -1;
+   rf.data = (char *) pf->data;
+   rf.pos = lpos = ck->begin;
+   rf.end = rf.cap = ck->end;
+   rf.eof = 1;
+
+   for (ii = 0; ii < nlits; ii++) {                                              //  literal scan from chunk start
+      lits[ii] = literals[ii];
+      lits[ii].hit = -1;
+      lits[ii].from = ck->begin;
+   }
+
+   while (! __atomic_load_n(&pf->stop,__ATOMIC_RELAXED))
+   {
+      if (Fstats) time0 = get_seconds();
+      more = 1;
+      if (Fliteral) more = recfile_skip(rf,lits,nlits,FignorecaseS);             //  skip records without literals
+      if (more) more = recfile_next(rf,-1,offset,cc);
+      if (more) {
+         if (cc >= cap) {                                                        //  record to string
+            if (buff) zfree(buff);
+            cap = cc + 1000;
+            buff = (char *) zmalloc(cap,0);
+         }
+         memcpy(buff,rf.data + offset,cc);
+         buff[cc] = 0;
+      }
+      if (Fstats) {
+         ck->st.Tread += get_seconds() - time0;
+         if (more && pf->pass == 1) ck->st.Nrecs++;
+      }
+      if (! more) break;
+
+      if (pf->pass == 1) {
+         if (killsearch) {
+            ck->stopped = 1;
+            break;
+         }
+         if (Tfiledeadline && (++nrecs & 1023) == 0 &&                           //  search time is up
+             get_seconds() > Tfiledeadline) {
+            ck->stopped = 2;
+            break;
+         }
+      }
+
+      recsearch(buff,Rmatch,nsrs,Rignore,nigs,recmatch,recignore);
+
+      if (recmatch + recignore == 0) continue;
+
+      if (pf->pass == 1 && nigs > 0) {
+         if ((ignorerule == ignore_any && recignore > 0) ||                      //  reject file
+             (ignorerule == ignore_rec_all && recignore == nigs)) {
+            ck->ignored = 1;
+            break;
+         }
+      }
+
+      if (recmatch > 0) {
+         if (matchrule == match_rec_all && recmatch < nsrs) recmatch = 0;        //  ignore record without all match strings
+         if (recignore > 0) {
+            if (ignorerule == ignore_match_any) recmatch = 0;                    //  ignore record with any ignore string
+            if (ignorerule == ignore_match_all)
+                if (recignore == nigs) recmatch = 0;                             //  ignore record with all ignore strings
+         }
+      }
+
+      if (recmatch > 0) {
+         ck->filematch += recmatch;
+         for (ii = 0; ii < nsrs; ii++) ck->Fmatch[ii] += Rmatch[ii];
+      }
+
+      if (recignore > 0)
+         for (ii = 0; ii < nigs; ii++) ck->Fignore[ii] += Rignore[ii];
+
+      if (recmatch > 0 && pf->pass == 2) {                                       //  matching record, line number
+         lnum += par_lines(rf.data,lpos,offset);
+         lpos = offset;
+         if (ck->nmatch == ck->mmatch) {
+            ck->mmatch = ck->mmatch ? 2 * ck->mmatch : 256;
+            pm = (parmatch *) zmalloc(ck->mmatch * sizeof(parmatch),0);
+            if (ck->nmatch) memcpy(pm,ck->matches,ck->nmatch * sizeof(parmatch));
+            if (ck->matches) zfree(ck->matches);
+            ck->matches = pm;
+         }
+         pm = &ck->matches[ck->nmatch++];
+         pm->offset = offset;
+         pm->cc = cc;
+         pm->line = lnum + 1;
+      }
+   }
+
+   if (ck->ignored || ck->stopped)
+      __atomic_store_n(&pf->stop,1,__ATOMIC_RELEASE);                            //  file is decided
+
+   if (pf->pass == 2) {                                                          //  records in chunk
+      lnum += par_lines(rf.data,lpos,ck->end);
+      if (ck->end > ck->begin && rf.data[ck->end-1] != '\n') lnum++;             //  last record without \n
+      ck->lines = lnum;
+   }
+
+   if (buff) zfree(buff);
+   return;
+}
+
+
+//  output a record of a large file, as filesearch()
+
+void parfile_names::par_record(recfile &rv, cchar *filename, int line, int64 offset, int cc,
+                               int match, char *&buff, int &cap)
+{
+   int      spans[100][2], nspans, ii, tline;
+   double   time0 = 0;
+
+   recfile_string(rv,offset,cc,buff,cap);
+   log_append2(0,"%5d  %s \n",line,buff);
+   if (outformat) out_record(filename,line,buff,match);
+
+   if (match && ! Fbatch) {                                                      //  GUI: make matching strings bold
+      if (Fstats) time0 = get_seconds();
+      nspans = recspans(buff,spans,100);
+      tline = textwidget_linecount(mLog) - 2;
+      for (ii = 0; ii < nspans; ii++)
+         textwidget_bold_word(mLog,tline,spans[ii][0]+7,spans[ii][1]-spans[ii][0]);
+      if (Fstats) stats.Tout += get_seconds() - time0;
+   }
+
+   return;
+}
+
+
+//  list the records following a match at line 'last', before line 'upto'
+//  next: file offset of the record after the match
+//  a spacer line follows if listfoll records are listed
+
+void parfile_names::par_follow(recfile &rv, cchar *filename, int last, int64 next, int upto,
+                               char *&buff, int &cap)
+{
+   int64    offset;
+   int      cc, line;
+
+   if (! listfoll) return;
+
+   rv.pos = next;
+   for (line = last + 1; line <= last + listfoll && line < upto; line++) {
+      if (! recfile_next(rv,-1,offset,cc)) return;                               //  file end
+      par_record(rv,filename,line,offset,cc,0,buff,cap);
+   }
+
+   if (line > last + listfoll) log_append2(0,"\n");
+   return;
+}
+
+
+//  list the records preceding a match at 'line' and 'offset', oldest first,
+//  not those listed as following the prior match at line 'last'
+
+void parfile_names::par_precede(recfile &rv, cchar *filename, int last, int64 offset, int line,
+                                char *&buff, int &cap)
+{
+   cchar    *nl;
+   int64    pos = offset, offset2;
+   int      cc, ii, first;
+
+   if (! listprec) return;
+
+   first = last ? last + listfoll + 1 : 1;                                       //  first record not listed
+   if (first < line - listprec) first = line - listprec;
+
+   for (ii = first; ii < line; ii++) {                                           //  back to the first record
+      nl = (cchar *) memrchr(rv.data,'\n',pos - 1);                              //    (pos - 1 is \n of prior record)
+      pos = nl ? nl + 1 - rv.data : 0;
+   }
+
+   rv.pos = pos;
+   for (ii = first; ii < line; ii++) {
+      recfile_next(rv,-1,offset2,cc);
+      par_record(rv,filename,ii,offset2,cc,0,buff,cap);
+   }
+
+   return;
+}
+
+
+/**
+ * @brief literal_init - choose the record search strategy for the search strings.
+ *        A token matching a search or ignore string contains the longest literal
+ *        part of the string (between wildcards), so records without any literal
+ *        need not be tokenized. If all literals have litmin or more bytes, the
+ *        file data is scanned for them, and only the records with hits are
+ *        searched (recfile_skip()). Short literals (*a*) would hit most records:
+ *        then all records are tokenized. Also if there are no search strings
+ *        (all records match), and with Unicode case folding (other bytes may
+ *        fold to a literal).
+ */
+void literal_init()                                                              //  2.8
+{
+   cchar    *pattern, *pp;
+   int      ii, cc;
+
+   Fliteral = nlits = 0;
+   if (nsrs == 0) return;
+   if (FignorecaseS && Futf8) return;
+
+   for (ii = 0; ii < nsrs + nigs; ii++)
+   {
+      pattern = (ii < nsrs) ? srstrings[ii] : igstrings[ii-nsrs];
+      literals[ii].cc = 0;
+
+      for (pp = pattern; *pp; pp += cc)                                          //  longest part without * or ?
+      {
+         cc = strcspn(pp,"*?");
+         if (cc == 0) cc = 1;
+         else if (cc > literals[ii].cc) {
+            literals[ii].text = pp;                                              //  (search strings are folded
+            literals[ii].cc = cc;                                                //    if ignore case)
+         }
+      }
+
+      if (literals[ii].cc < litmin) return;
+   }
+
+   nlits = nsrs + nigs;
+   Fliteral = 1;
+   return;
+}
+
+
+/**
+ * @brief order_init - order the search and ignore strings for recsearch().
+ *        A string with fewer literal characters (more wildcards) is expected
+ *        to match more tokens and is tried first, so that a record outcome is
+ *        settled sooner. A literal end (not '*') counts as half a character.
+ *        If one ignore string settles a record (ignore any), the ignore
+ *        strings are tried before the search strings.
+ */
+void order_init()                                                                //  2.8
+{
+   int      score[2*Smax];
+   int      ii, jj, kk, ns;
+   cchar    *pattern, *pp;
+
+   ns = nsrs + nigs;
+
+   for (ii = 0; ii < ns; ii++)
+   {
+      pattern = (ii < nsrs) ? srstrings[ii] : igstrings[ii-nsrs];
+      score[ii] = 0;
+      for (pp = pattern; *pp; pp++)                                              //  2 per literal character
+         if (*pp != '*' && *pp != '?') score[ii] += 2;
+      if (*pattern && *pattern != '*') score[ii]++;                              //  1 per literal end
+      if (pp > pattern && pp[-1] != '*') score[ii]++;
+      if (ii >= nsrs && (ignorerule == ignore_any || ignorerule == ignore_match_any))
+         score[ii] -= 1000;                                                      //  ignore strings first
+   }
+
+   for (ii = 0; ii < ns; ii++)                                                   //  insertion sort, stable
+   {
+      kk = ii;
+      for (jj = ii - 1; jj >= 0 && score[strorder[jj]] > score[kk]; jj--)
+         strorder[jj+1] = strorder[jj];
+      strorder[jj+1] = kk;
+   }
+
+   return;
+}
+
+
+/**
+ * @brief recsearch - search a single record for strings to match and strings not to match (ignore strings)
+ *        The counts per string are 0 or more than 0: tokens are not tested again for a string
+ *        found in the record, and tokenizing stops when the rules settle the record outcome.
+ *        Also called by the chunk workers of a large file (counters to rstats).
+ * @param buff
+ * @param Rmatch
+ * @param nsrs
+ * @param Rignore
+ * @param nigs
+ * @param recmatch
+ * @param recignore
+ */
+void recsearch(char *buff,                                                       //  record to search
+               int Rmatch[], int nsrs,                                           //  search strings matched
+               int Rignore[], int nigs,                                          //  ignore strings matched
+               int &recmatch, int &recignore)                                    //  returned total counts
+{
+   char     buff2[2000], *token, *tokens[500], *pp, *save;
+   int      ii, jj, kk, cc, segcc, ntok, utf8, tcc = 0;
+   int      igany, settled = 0;
+   uint     mbits, ibits;
+   uint64   hash = 0;
+   tokmemo  *tm;
+   double   time0 = 0, time1;
+   int      (*matchwild)(cchar *, cchar *) = MatchWild;
+
+   for (ii = 0; ii < Smax; ii++)                                                 //  no strings found in record yet
+      Rmatch[ii] = Rignore[ii] = 0;
+
+   recmatch = recignore = 0;
+
+   if (Fstats) time0 = get_seconds();                                            //  2.8
+
+   cc = strlen(buff);
+   utf8 = Futf8 && ! utf8_ascii(buff,cc);                                        //  UTF-8 mode, not all ASCII          2.8
+   if (utf8) matchwild = MatchWildUTF8;
+
+   if (Fmemo && ! memo) memo = (tokmemo *) zmalloc(memoslots * sizeof(tokmemo));
+
+   igany = (ignorerule == ignore_any || ignorerule == ignore_match_any);         //  one ignore string settles record
+
+   for (pp = buff; pp < buff + cc && ! settled; pp += segcc)                     //  long records in segments           2.8
+   {
+      segcc = recsegment(pp,buff + cc - pp,recsegcc);
+
+      if (utf8)
+         ntok = rectokens(pp,segcc,buff2,2000,tokens,0,500,FignorecaseS);        //  tokens by code point, opt. folded
+
+      else
+      {
+         if (FignorecaseS) strFold(buff2,pp,segcc+1);                            //  copy and fold case (search strings 2.8
+         else {                                                                  //    folded in filescan()), copy before
+            memcpy(buff2,pp,segcc);                                              //      destruction by strtok_r()
+            buff2[segcc] = 0;
+         }
+         ntok = 0;                                                               //  get strings defined by delimiters
+         for (token = strtok_r(buff2,delims,&save); token;                       //  (max. 500 in 999 chars.)           2.8
+              token = strtok_r(0,delims,&save))
+            tokens[ntok++] = token;
+      }
+
+      if (Fstats) {                                                              //  tokenize time
+         time1 = get_seconds();
+         rstats->Ttoken += time1 - time0;
+         time0 = time1;
+      }
+
+      for (jj = 0; jj < ntok; jj++)                                              //  (case is folded if ignore case)    2.8
+      {
+         token = tokens[jj];
+         tm = 0;
+
+         if (Fmemo) {                                                            //  token seen before in this file:
+            tcc = strlen(token);                                                 //    matches from cache              2.8
+            if (tcc <= memocc) {
+               hash = zhash64(token,tcc);
+               tm = &memo[hash & (memoslots-1)];
+               if (Fstats) rstats->Nmemo++;
+               if (tm->gen == memogen && tm->hash == hash && tm->cc == tcc &&
+                   memcmp(tm->text,token,tcc) == 0) {
+                  if (Fstats) rstats->Hmemo++;
+                  mbits = tm->mbits;
+                  ibits = tm->ibits;
+                  tm = 0;
+                  goto counts;
+               }
+            }
+         }
+
+         mbits = ibits = 0;
+
+         for (kk = 0; kk < nsrs + nigs; kk++)                                    //  match with search and ignore
+         {                                                                       //    strings, selective last        2.8
+            ii = strorder[kk];                                                   //  (all strings if for the cache,
+            if (ii < nsrs) {                                                     //    else not those found already)
+               if (! tm && Rmatch[ii]) continue;
+               if (matchwild(srstrings[ii],token) == 0) mbits |= 1 << ii;
+            }
+            else {
+               ii -= nsrs;
+               if (! tm && Rignore[ii]) continue;
+               if (matchwild(igstrings[ii],token) == 0) {
+                  ibits |= 1 << ii;
+                  if (! tm && igany) break;                                      //  record is settled
+               }
+            }
+         }
+
+         if (tm) {                                                               //  add to cache, replace prior token
+            tm->hash = hash;
+            tm->gen = memogen;
+            tm->mbits = mbits;
+            tm->ibits = ibits;
+            tm->cc = tcc;
+            memcpy(tm->text,token,tcc);
+         }
+
+      counts:
+         for (ii = 0; mbits; ii++, mbits >>= 1)
+         {
+            if (mbits & 1) {
+               Rmatch[ii]++;
+               if (Rmatch[ii] == 1) recmatch++;                                  //  search strings found, 0...nsrs
+            }
+         }
+
+         if (nsrs == 0) recmatch++;                                              //  no search strings = match
+
+         for (ii = 0; ibits; ii++, ibits >>= 1)
+         {
+            if (ibits & 1) {
+               Rignore[ii]++;
+               if (Rignore[ii] == 1) recignore++;                                //  ignore strings found, 0...nigs
+            }
+         }
+
+         if (recignore && (igany || recignore == nigs)) settled = 1;             //  outcome settled by ignore strings
+         if (nsrs && recmatch == nsrs && recignore == nigs) settled = 1;         //    or nothing more to find
+         if (settled) {
+            if (Fstats && (jj < ntok - 1 || pp + segcc < buff + cc)) rstats->Nsettle++;
+            break;
+         }
+      }
+
+      if (Fstats) {                                                              //  match time
+         time1 = get_seconds();
+         rstats->Tmatch += time1 - time0;
+         time0 = time1;
+      }
+   }
+
+   return;
+}
+
+
+/**
+ * @brief recsegment - get the length of the next record segment to tokenize.
+ *        Long records are searched in segments of at most maxcc bytes. A segment
+ *        ends before a delimiter if there is one in the second half, else at a
+ *        UTF-8 character boundary (a longer string is split).
+ * @param record     segment start
+ * @param cc         remaining record length
+ * @param maxcc      max. segment length
+ * @return segment length
+ */
+int recsegment(cchar *record, int cc, int maxcc)                                 //  2.8
+{
+   int      ii;
+
+   if (cc <= maxcc) return cc;
+
+   for (ii = maxcc; ii > maxcc / 2; ii--)                                        //  end before a delimiter
+      if (strchr(delims,record[ii])) return ii;
+
+   for (ii = maxcc; ii > 0; ii--)                                                //  end before a UTF-8 lead byte
+      if ((record[ii] & 0xc0) != 0x80) return ii;
+
+   return maxcc;
+}
+
+
+//
+/**
+ * @brief recsearch1 - Search a record for a string between delimiters which matches an input wildcard string.
+ *                     Returns position of matching string within record, and its length in 'cc'.
+ *                     Returns null if no match is found.
+ *                     If ignorecase is not null, case is ignored in the string comparison.
+ * @param record
+ * @param wildstr
+ * @param delims
+ * @param cc
+ * @param ignorecase
+ * @return
+ */
+char* recsearch1(char* const record, char* const wildstr, char* const delims, int& cc, bool ignorecase){                               // 2.5
+  char     *pp1, *pp2, delim;
+  int      mm;
+  pp1 = record;
+
+  while (true){
     //  scan to next non-delimiter
-    while ((*pp1=='\0') && strchr(delims,*pp1)){
+    while (*pp1 && strchr(delims,*pp1)){                                       //  2.8
       ++pp1;
     }
     if(*pp1=='\0'){
@@ -1107,125 +5773,2150 @@ char* recsearch1(char* const record, char* const wildstr, char* const delims, in
     }
     pp1 = pp2;                                                                 //  pp1 = next delimiter or null
   }
-exit:
-  return pp1;
+exit:
+  return pp1;
+}
+
+/**
+ * @brief recspans - get the positions of all strings in a record matching any search string.
+ *                   Returns span count, spans are [begin, end) offsets in order of position.
+ * @param record
+ * @param spans
+ * @param maxspans
+ * @return
+ */
+int recspans(char *record, int spans[][2], int maxspans)                         //  2.8
+{
+   char     *pp, tokbuff[2000], *tokens[500];
+   int      ii, jj, kk, cc, ns = 0, begin, ntok, tspans[500][2];
+   int      reccc, segcc;
+
+   if (Futf8)                                                                    //  UTF-8 mode, tokens by code point
+   {
+      reccc = strlen(record);
+      for (begin = 0; begin < reccc && ns < maxspans; begin += segcc)            //  long records in segments
+      {
+         segcc = recsegment(record+begin,reccc-begin,recsegcc);
+         ntok = rectokens(record+begin,segcc,tokbuff,2000,tokens,tspans,500,FignorecaseS);
+         for (jj = 0; jj < ntok && ns < maxspans; jj++)
+         for (ii = 0; ii < nsrs; ii++)
+         {
+            if (MatchWildUTF8(srstrings[ii],tokens[jj]) == 0) {
+               spans[ns][0] = begin + tspans[jj][0];
+               spans[ns][1] = begin + tspans[jj][1];
+               ns++;
+               break;
+            }
+         }
+      }
+      return ns;
+   }
+
+   for (ii = 0; ii < nsrs; ii++)
+   {
+      pp = record;
+      while (ns < maxspans) {
+         pp = recsearch1(pp,srstrings[ii],delims,cc,FignorecaseS);               //  next matching string and length
+         if (! pp) break;
+         begin = pp - record;
+         for (jj = 0; jj < ns; jj++)                                             //  find position in sorted list
+            if (spans[jj][0] >= begin) break;
+         if (jj == ns || spans[jj][0] != begin) {                                //  skip if already found
+            for (kk = ns; kk > jj; kk--) {
+               spans[kk][0] = spans[kk-1][0];
+               spans[kk][1] = spans[kk-1][1];
+            }
+            spans[jj][0] = begin;
+            spans[jj][1] = begin + cc;
+            ns++;
+         }
+         pp += cc;
+      }
+   }
+
+   return ns;
+}
+
+/**
+ * @brief delims_init - make delimiter tables for UTF-8 mode from the delimiters string.
+ *        Each character (code point) in delims is a delimiter. If blank is a delimiter,
+ *        so are the Unicode spaces, and if any ASCII punctuation is a delimiter, so is
+ *        Unicode punctuation (see utf8_class()).
+ */
+void delims_init()                                                               //  2.8
+{
+   cchar    *pp;
+   int      code, cc;
+
+   memset(delimtab,0,128);
+   nudelims = 0;
+   Fdelimpunct = 0;
+
+   for (pp = delims; *pp; pp += cc)
+   {
+      code = utf8_decode(pp,cc);
+      if (code < 128) {
+         delimtab[code] = 1;
+         if (utf8_class(code) == 2) Fdelimpunct = 1;
+      }
+      else if (nudelims < 100) udelims[nudelims++] = code;
+   }
+
+   return;
+}
+
+
+/**
+ * @brief delim_utf8 - test if a code point is a delimiter (UTF-8 mode)
+ * @param code
+ * @return 1 if delimiter
+ */
+int delim_utf8(int code)                                                         //  2.8
+{
+   int      ii, cls;
+
+   if (code < 128) return delimtab[code];
+
+   for (ii = 0; ii < nudelims; ii++)
+      if (code == udelims[ii]) return 1;
+
+   cls = utf8_class(code);
+   if (cls == 1 && delimtab[' ']) return 1;
+   if (cls == 2 && Fdelimpunct) return 1;
+   return 0;
+}
+
+
+/**
+ * @brief delim_check - check that a search or ignore string has no delimiters
+ *        (except blank, which separates the strings, and '*')
+ * @param string
+ * @param what   "search" or "ignore" for the error message
+ * @return 0 if OK, 1 if delimiter found (error is reported)
+ */
+int delim_check(cchar *string, cchar *what)                                      //  2.8
+{
+   cchar    *pp;
+   int      code, cc;
+
+   for (pp = string; *pp; pp += cc)
+   {
+      if (Futf8) code = utf8_decode(pp,cc);                                      //  UTF-8 character
+      else {
+         code = (uchar) *pp;                                                     //  byte
+         cc = 1;
+      }
+
+      if (code == ' ' || code == '*') continue;
+      if (Futf8 ? delim_utf8(code) : strchr(delims,*pp) != 0) {
+         log_error("delimiter  %.*s  is contained in %s string",cc,pp,what);
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+/**
+ * @brief rectokens - break a record into tokens between delimiters, by UTF-8 code point.
+ *        The tokens are copied into tokbuff with null terminators, case folded if
+ *        fold is set. Returns the token count, and the [begin, end) offsets of each
+ *        token in the record if spans is not null.
+ * @param record
+ * @param reccc      record length
+ * @param tokbuff    output buffer for tokens
+ * @param maxcc      tokbuff size
+ * @param tokens     output pointers to tokens in tokbuff
+ * @param spans      optional output token positions in record
+ * @param maxtok     max. tokens
+ * @param fold       1 to fold case
+ * @return token count
+ */
+int rectokens(cchar *record, int reccc, char *tokbuff, int maxcc,                //  2.8
+              char *tokens[], int spans[][2], int maxtok, int fold)
+{
+   int      pos = 0, out = 0, ntok = 0, begin = -1;
+   int      code, cc;
+
+   while (true)
+   {
+      if (pos < reccc) code = utf8_decode(record+pos,cc);
+      else code = 0;                                                             //  end of record
+
+      if (code == 0 || delim_utf8(code) || out + 5 > maxcc) {                    //  end of token
+         if (begin >= 0) {
+            tokbuff[out++] = 0;
+            if (spans) {
+               spans[ntok][0] = begin;
+               spans[ntok][1] = pos;
+            }
+            ntok++;
+            begin = -1;
+         }
+         if (code == 0 || ntok == maxtok || out + 5 > maxcc) break;
+         pos += cc;
+         continue;
+      }
+
+      if (begin < 0) {                                                           //  start of token
+         begin = pos;
+         tokens[ntok] = tokbuff + out;
+      }
+
+      if (fold) code = utf8_foldcode(code);
+      out += utf8_encode(code,tokbuff+out);
+      pos += cc;
+   }
+
+   return ntok;
+}
+
+
+//  token index: for a search path (the folder before the first '*'), the
+//  distinct tokens of all files, as recsearch() gets them with the string
+//  delimiters, and for each token the files and records (lines) having it.
+//  A search string is matched against the sorted token vocabulary instead of
+//  the files: a literal start (abc*) is a range of the vocabulary, other
+//  strings (*abc*) are tested against every token. The postings of matching
+//  tokens give the matching records of each file, and the match and ignore
+//  rules are then applied as in filesearch(). The files found are the same
+//  as for a file search, if the index is up to date.
+//
+//  The index is a file in indexDir, named by a hash of its key: the search
+//  path, delimiters, and the options that change the files or their tokens.
+//  An update reads new and changed files (mod time, size) and keeps the
+//  postings of the other files.
+//
+//  file layout:  idxhead, key, idxfile[nfiles], paths, postings, tokens, idxtoken[ntokens]
+//  postings of a token, by file and record (line), ascending:
+//     new file:   varint (file id delta * 2 + 1), varint line
+//     same file:  varint (line delta * 2)
+//  Tokens are sorted by case folded text, then text, so that a literal start
+//  is one range with or without case. Files have the ids of the prior index
+//  (minus removed files), then new and changed files, and 'seq' for the walk
+//  order, to report the files found in the same order as a file search.
+
+namespace index_names
+{
+   struct idxbuff {                                                              //  growable byte buffer
+      uchar    *buff;
+      int64    cc, cap;
+   };
+
+   struct idxpost {                                                              //  postings of a token, new files
+      idxbuff  bb;
+      int      file, line;                                                       //  last file and line added
+   };
+
+   struct idxwalk {                                                              //  file from walk, in walk order
+      char     *path;
+      int64    mtime, stime, ssize;
+      int      oldid;                                                            //  unchanged, id in prior index
+      int      newid;                                                            //  read, id among read files
+   };
+
+   struct idxevent {                                                             //  search or ignore string in record
+      int      file, line, str;
+   };
+
+   Zhash       *vocab;                                                           //  tokens of files read >> posts[]
+   idxpost     *posts;
+   int         Nposts, Mposts;
+
+   void addcc(idxbuff &bb, const void *data, int64 cc);
+   void putv(idxbuff &bb, uint64 vv);
+   uint64 getv(const uchar *&pp);
+   int tokcomp(cchar *tok1, cchar *tok2);
+   int foldcompN(cchar *tok, cchar *prefix, int cc);
+   int evcomp(cchar *rec1, cchar *rec2);
+   void index_read(cchar *file, int fileid);
+   void index_add(cchar *token, int fileid, int line);
+   int index_match(cchar *pattern, cchar *token);
+}
+
+
+//  add data to a buffer, data = null to make space only
+
+void index_names::addcc(idxbuff &bb, const void *data, int64 cc)
+{
+   uchar    *buff2;
+
+   if (bb.cc + cc > bb.cap) {
+      bb.cap = bb.cap ? 2 * bb.cap : 16;
+      if (bb.cap < bb.cc + cc) bb.cap = bb.cc + cc;
+      buff2 = (uchar *) zmalloc(bb.cap,0);
+      if (bb.cc) memcpy(buff2,bb.buff,bb.cc);
+      if (bb.buff) zfree(bb.buff);
+      bb.buff = buff2;
+   }
+
+   if (! data) return;
+   memcpy(bb.buff + bb.cc,data,cc);
+   bb.cc += cc;
+   return;
+}
+
+
+//  add a number to a buffer, 7 bits per byte, low bits first
+
+void index_names::putv(idxbuff &bb, uint64 vv)
+{
+   addcc(bb,0,10);
+   while (vv >= 0x80) {
+      bb.buff[bb.cc++] = (vv & 0x7f) | 0x80;
+      vv >>= 7;
+   }
+   bb.buff[bb.cc++] = vv;
+   return;
+}
+
+
+uint64 index_names::getv(const uchar *&pp)
+{
+   uint64   vv = 0;
+   int      shift = 0;
+
+   while (*pp & 0x80) {
+      vv |= (uint64) (*pp++ & 0x7f) << shift;
+      shift += 7;
+   }
+   vv |= (uint64) *pp++ << shift;
+   return vv;
+}
+
+
+//  token order: case folded text, then text
+
+int index_names::tokcomp(cchar *tok1, cchar *tok2)
+{
+   const uchar *uu1 = (const uchar *) tok1, *uu2 = (const uchar *) tok2;
+   int         ii, cc;
+
+   for (ii = 0; ; ii++) {
+      cc = zfoldcase[uu1[ii]] - zfoldcase[uu2[ii]];
+      if (cc) return (cc < 0) ? -1 : 1;
+      if (! uu1[ii]) break;
+   }
+
+   cc = strcmp(tok1,tok2);
+   return (cc < 0) ? -1 : (cc > 0);
+}
+
+
+//  compare start of case folded token with folded prefix of cc bytes
+
+int index_names::foldcompN(cchar *tok, cchar *prefix, int cc)
+{
+   const uchar *uu1 = (const uchar *) tok, *uu2 = (const uchar *) prefix;
+
+   for (int ii = 0; ii < cc; ii++)
+      if (zfoldcase[uu1[ii]] != uu2[ii]) return zfoldcase[uu1[ii]] - uu2[ii];
+   return 0;
+}
+
+
+int index_names::evcomp(cchar *rec1, cchar *rec2)                                //  event order: file, line, string
+{
+   idxevent *ev1 = (idxevent *) rec1, *ev2 = (idxevent *) rec2;
+
+   if (ev1->file != ev2->file) return (ev1->file < ev2->file) ? -1 : 1;
+   if (ev1->line != ev2->line) return (ev1->line < ev2->line) ? -1 : 1;
+   if (ev1->str != ev2->str) return (ev1->str < ev2->str) ? -1 : 1;
+   return 0;
+}
+
+
+//  get index key and index file for the current search path and options
+//  root: folder to index, as walk_open() gets it for search path + '*'
+
+void index_file(char *root, char *key, char *file)                               //  2.8
+{
+   char     *pp;
+   uint64   hash;
+
+   snprintf(root,XFCC,"%s*",sr_path);
+   pp = strchr(root,'*');
+   while ((*pp != '/') && (pp > root)) pp--;
+   if (pp > root) *(pp+1) = 0;
+
+   snprintf(key,XFCC+200,"path %s\ndelimiters %s\noptions utf8 %d unique %d gitignore %d "
+                         "compressed %d archives %d\n",root,delims,Futf8,Funique,Fgitignore,
+                         Funpack,Farchive);
+   hash = zhash64(key,strlen(key));
+   snprintf(file,XFCC,"%s/%016lx.index",indexDir,hash);
+   return;
+}
+
+
+//  map an index file and check its key
+//  returns 0 if OK
+
+int index_open(fwindex &fx, cchar *file, cchar *key)                             //  2.8
+{
+   STATB    statb;
+   void     *map;
+   int      fd;
+   idxhead  *head;
+
+   memset(&fx,0,sizeof(fwindex));
+
+   fd = open(file,O_RDONLY);
+   if (fd < 0) return errno;
+   if (fstat(fd,&statb) || statb.st_size < (int64) sizeof(idxhead)) {
+      close(fd);
+      return EINVAL;
+   }
+   map = mmap(0,statb.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+   close(fd);
+   if (map == MAP_FAILED) return errno;
+
+   fx.map = (char *) map;
+   fx.mapcc = statb.st_size;
+   head = fx.head = (idxhead *) map;
+
+   if (memcmp(head->magic,indexmagic,8) || head->end != fx.mapcc ||              //  other format, incomplete
+       strcmp(fx.map + head->keyoff,key)) {                                      //  other key (hash collision)
+      index_close(fx);
+      return EINVAL;
+   }
+
+   fx.files = (idxfile *) (fx.map + head->fileoff);
+   fx.paths = fx.map + head->pathoff;
+   fx.posts = (uchar *) fx.map + head->postoff;
+   fx.tokens = fx.map + head->tokoff;
+   fx.vocab = (idxtoken *) (fx.map + head->vocoff);
+   return 0;
+}
+
+
+void index_close(fwindex &fx)                                                    //  2.8
+{
+   if (fx.map) munmap(fx.map,fx.mapcc);
+   fx.map = 0;
+   return;
+}
+
+
+//  read a file and add its tokens to the new postings
+
+void index_names::index_read(cchar *file, int fileid)
+{
+   recfile  rf;
+   int64    offset;
+   int      cc, rcc, segcc, ntok, line = 0, utf8, ii, cap = 0;
+   char     buff2[2000], *tokens[500], *token, *rec = 0, *pp;
+
+   Zarena_reset(&Farena);
+   if (recfile_open(rf,file)) return;
+
+   while (recfile_next(rf,-1,offset,cc))                                         //  same records and tokens
+   {                                                                             //    as filesearch(), recsearch()
+      line++;
+      recfile_string(rf,offset,cc,rec,cap);
+      rcc = strlen(rec);
+      utf8 = Futf8 && ! utf8_ascii(rec,rcc);
+
+      for (pp = rec; pp < rec + rcc; pp += segcc)
+      {
+         segcc = recsegment(pp,rec + rcc - pp,recsegcc);
+
+         if (utf8) ntok = rectokens(pp,segcc,buff2,2000,tokens,0,500,0);
+         else {
+            memcpy(buff2,pp,segcc);
+            buff2[segcc] = 0;
+            ntok = 0;
+            for (token = strtok(buff2,delims); token; token = strtok(0,delims))
+               tokens[ntok++] = token;
+         }
+
+         for (ii = 0; ii < ntok; ii++)
+            index_add(tokens[ii],fileid,line);
+      }
+
+      if (killsearch) break;
+   }
+
+   recfile_close(rf);
+   return;
+}
+
+
+//  add token in file record to the new postings
+
+void index_names::index_add(cchar *token, int fileid, int line)
+{
+   idxpost  *ip, *posts2;
+   int      ent, added;
+
+   ent = vocab->Put(token,added);
+   if (added) {
+      if (Nposts == Mposts) {
+         Mposts = Mposts ? 2 * Mposts : 4096;
+         posts2 = (idxpost *) zmalloc(Mposts * sizeof(idxpost),0);
+         if (Nposts) memcpy(posts2,posts,Nposts * sizeof(idxpost));
+         if (posts) zfree(posts);
+         posts = posts2;
+      }
+      ip = &posts[Nposts];
+      memset(ip,0,sizeof(idxpost));
+      ip->file = -1;
+      vocab->Value(ent) = Nposts++;
+   }
+
+   ip = &posts[vocab->Value(ent)];
+   if (ip->file == fileid) {
+      if (ip->line == line) return;                                              //  token again in same record
+      putv(ip->bb,(line - ip->line) * 2);
+   }
+   else {
+      putv(ip->bb,(fileid - ip->file) * 2 + 1);
+      putv(ip->bb,line);
+   }
+   ip->file = fileid;
+   ip->line = line;
+   return;
+}
+
+
+//  build or update the index of the files below root
+//  returns 0 if OK
+
+int index_update(cchar *root, cchar *key, cchar *file)                           //  2.8
+{
+   using namespace index_names;
+
+   fwindex     old;
+   idxhead     head;
+   idxfile     *files = 0;
+   idxwalk     *walked = 0, *walked2, *iw;
+   idxbuff     out, toks;
+   idxtoken    *newvocab = 0, *nv;
+   idxpost     *np;
+   filewalk    walk;
+   Zarena      arena;
+   Zhash       *oldpaths = 0;
+   STATB       statb;
+   FILE        *fid;
+   char        wpath[XFCC], apath[XFCC], tfile[XFCC+10], *pp;
+   char        **newtoks = 0;
+   cchar       *pfile, *tok;
+   const uchar *ip, *ipend;
+   int64       pathcc, postcc, vv;
+   int         *oldmap = 0;
+   int         nold = 0, noldtok = 0, nwalk = 0, Mwalk = 1000, nnew = 0, nkept, nchanged, nfiles, err = 0;
+   int         ii, jj, kk, ent, added, comp, lastfile, filenum, ntok, Mvocab, Nvocab = 0;
+   double      time0;
+
+   time0 = get_seconds();
+   mkdir(indexDir,0700);
+
+   if (index_open(old,file,key) == 0) {                                          //  prior index, find files by path
+      nold = old.head->nfiles;
+      noldtok = old.head->ntokens;
+      oldpaths = new Zhash(2 * nold);
+      oldmap = (int *) zmalloc((nold + 1) * sizeof(int),0);
+      for (ii = 0; ii < nold; ii++) {
+         ent = oldpaths->Put(old.paths + old.files[ii].path,added);
+         oldpaths->Value(ent) = ii;
+         oldmap[ii] = -1;
+      }
+   }
+
+   vocab = new Zhash(65536);
+   posts = 0;
+   Nposts = Mposts = 0;
+   Zarena_open(&arena,65536);
+   walked = (idxwalk *) zmalloc(Mwalk * sizeof(idxwalk),0);
+   *apath = 0;
+
+   snprintf(wpath,XFCC,"%s*",root);
+   walk_open(walk,wpath,(Funique ? walk_unique : 0) |
+                        (Fgitignore ? walk_gitignore : 0) |
+                        (Farchive ? walk_archive : 0));
+
+   while ((pfile = walk_next(walk)))                                             //  all files below root
+   {
+      if (nwalk == Mwalk) {
+         walked2 = (idxwalk *) zmalloc(2 * Mwalk * sizeof(idxwalk),0);
+         memcpy(walked2,walked,Mwalk * sizeof(idxwalk));
+         zfree(walked);
+         walked = walked2;
+         Mwalk *= 2;
+      }
+
+      iw = &walked[nwalk];
+      if (walk.arc) {                                                            //  archive member: stamp of archive,
+         if (! strmatch(apath,walk.arc->path)) {                                 //    date of member
+            strncpy0(apath,walk.arc->path,XFCC);
+            if (stat(apath,&statb)) memset(&statb,0,sizeof(statb));
+         }
+         iw->mtime = walk.arc->mtime;
+      }
+      else {
+         if (stat(pfile,&statb)) continue;
+         iw->mtime = statb.st_mtime;
+      }
+      iw->stime = statb.st_mtim.tv_sec * 1000000000LL + statb.st_mtim.tv_nsec;
+      iw->ssize = statb.st_size;
+      iw->path = Zarena_strdup(&arena,pfile);
+      iw->oldid = iw->newid = -1;
+      nwalk++;
+
+      if (oldpaths && (ent = oldpaths->Find(pfile)) >= 0) {                      //  in prior index
+         ii = oldpaths->Value(ent);
+         if (old.files[ii].stime == iw->stime && old.files[ii].ssize == iw->ssize &&
+             old.files[ii].mtime == iw->mtime && oldmap[ii] < 0) {               //  unchanged, keep postings
+            oldmap[ii] = 0;
+            iw->oldid = ii;
+            continue;
+         }
+         if (oldmap[ii] < 0) oldmap[ii] = 1;                                     //  changed
+      }
+
+      iw->newid = nnew++;                                                        //  new or changed, read tokens
+      index_read(pfile,iw->newid);
+      if (killsearch) break;
+      zmainloop();
+   }
+
+   walk_close(walk);
+
+   for (ii = nkept = nchanged = 0; ii < nold; ii++) {                            //  kept files, new ids in same order
+      if (oldmap[ii] == 1) nchanged++;
+      oldmap[ii] = (oldmap[ii] == 0) ? nkept++ : -1;
+   }
+   nfiles = nkept + nnew;
+
+   for (ii = 0; ii < nwalk; ii++)                                                //  anything changed
+      if (walked[ii].oldid < 0 || old.files[walked[ii].oldid].seq != ii) break;
+   if (killsearch || (old.map && ii == nwalk && nkept == nold))                  //  no, or killed
+      goto cleanup;
+
+   snprintf(tfile,XFCC+10,"%s.new",file);                                        //  write new index, then rename
+   fid = fopen(tfile,"w");
+   if (! fid) {
+      log_error("%s: %s",tfile,strerror(errno));
+      err = 1;
+      goto cleanup;
+   }
+   setvbuf(fid,0,_IOFBF,1024*1024);
+
+   memset(&head,0,sizeof(head));
+   fwrite(&head,sizeof(head),1,fid);                                             //  header, written again at end
+   head.keyoff = ftell(fid);
+   fwrite(key,strlen(key)+1,1,fid);
+   while (ftell(fid) % 8) putc(0,fid);
+
+   files = (idxfile *) zmalloc((nfiles + 1) * sizeof(idxfile));                  //  files by id
+   for (ii = 0; ii < nwalk; ii++) {
+      iw = &walked[ii];
+      kk = (iw->oldid >= 0) ? oldmap[iw->oldid] : nkept + iw->newid;
+      files[kk].mtime = iw->mtime;
+      files[kk].stime = iw->stime;
+      files[kk].ssize = iw->ssize;
+      files[kk].seq = ii;
+      files[kk].path = (int64) iw->path;                                         //  (set below)
+   }
+   for (kk = 0, pathcc = 0; kk < nfiles; kk++) {
+      pp = (char *) files[kk].path;
+      files[kk].path = pathcc;
+      pathcc += strlen(pp) + 1;
+      walked[kk].path = pp;                                                      //  (walked[] >> paths by id)
+   }
+
+   head.fileoff = ftell(fid);
+   fwrite(files,sizeof(idxfile),nfiles,fid);
+   head.pathoff = ftell(fid);
+   for (kk = 0; kk < nfiles; kk++)
+      fwrite(walked[kk].path,strlen(walked[kk].path)+1,1,fid);
+
+   newtoks = (char **) zmalloc((Nposts + 1) * sizeof(char *),0);                 //  new tokens, sorted
+   ntok = 0;
+   for (ent = vocab->GetNext(-1); ent >= 0; ent = vocab->GetNext(ent))
+      newtoks[ntok++] = (char *) vocab->Key(ent);
+   if (ntok > 1) HeapSort(newtoks,ntok,tokcomp);
+
+   memset(&out,0,sizeof(out));
+   memset(&toks,0,sizeof(toks));
+   Mvocab = noldtok + ntok + 1;
+   newvocab = (idxtoken *) zmalloc(Mvocab * sizeof(idxtoken),0);
+
+   head.postoff = ftell(fid);
+   postcc = 0;
+
+   for (ii = jj = 0; ii < noldtok || jj < ntok; )                                //  merge prior and new tokens
+   {
+      if (ii == noldtok) comp = 1;
+      else if (jj == ntok) comp = -1;
+      else comp = tokcomp(old.tokens + old.vocab[ii].str,newtoks[jj]);
+
+      out.cc = 0;
+      lastfile = -1;
+      tok = (comp <= 0) ? old.tokens + old.vocab[ii].str : newtoks[jj];
+
+      if (comp <= 0) {                                                           //  prior postings of kept files
+         ip = old.posts + old.vocab[ii].post;
+         ipend = ip + old.vocab[ii].postcc;
+         filenum = -1;
+         kk = -1;
+         while (ip < ipend) {
+            vv = getv(ip);
+            if (vv & 1) {                                                        //  next file
+               filenum += vv >> 1;
+               kk = oldmap[filenum];
+               vv = getv(ip);                                                    //  its first line
+               if (kk < 0) continue;
+               putv(out,(kk - lastfile) * 2 + 1);
+               putv(out,vv);
+               lastfile = kk;
+            }
+            else if (kk >= 0) putv(out,vv);                                      //  same file, line delta
+         }
+         ii++;
+      }
+
+      if (comp >= 0) {                                                           //  postings of files read
+         np = &posts[vocab->Value(vocab->Find(newtoks[jj]))];
+         ip = np->bb.buff;
+         vv = getv(ip);                                                          //  first file, id among read files
+         kk = nkept + (vv >> 1) - 1;
+         putv(out,(kk - lastfile) * 2 + 1);
+         addcc(out,ip,np->bb.cc - (ip - np->bb.buff));                           //  rest unchanged
+         jj++;
+      }
+
+      if (! out.cc) continue;                                                    //  token only in removed files
+
+      nv = &newvocab[Nvocab++];
+      nv->str = toks.cc;
+      nv->post = postcc;
+      nv->postcc = out.cc;
+      addcc(toks,tok,strlen(tok) + 1);                                           //  token with null
+      fwrite(out.buff,out.cc,1,fid);
+      postcc += out.cc;
+   }
+
+   head.tokoff = ftell(fid);
+   fwrite(toks.buff,toks.cc,1,fid);
+   while (ftell(fid) % 8) putc(0,fid);
+   head.vocoff = ftell(fid);
+   fwrite(newvocab,sizeof(idxtoken),Nvocab,fid);
+   head.end = ftell(fid);
+
+   memcpy(head.magic,indexmagic,8);
+   head.nfiles = nfiles;
+   head.ntokens = Nvocab;
+   fseek(fid,0,SEEK_SET);
+   fwrite(&head,sizeof(head),1,fid);
+
+   if (fclose(fid) || rename(tfile,file)) {
+      log_error("%s: %s",file,strerror(errno));
+      remove(tfile);
+      err = 1;
+   }
+
+   if (out.buff) zfree(out.buff);
+   if (toks.buff) zfree(toks.buff);
+
+cleanup:
+   log_append(0," index update: %d files read (%d new, %d changed), %d unchanged, "
+                "%d removed, %.3f secs \n",nnew, nnew - nchanged, nchanged, nkept,
+                nold - nkept - nchanged, get_seconds() - time0);
+
+   for (ii = 0; ii < Nposts; ii++)
+      if (posts[ii].bb.buff) zfree(posts[ii].bb.buff);
+   if (posts) zfree(posts);
+   posts = 0;
+   delete vocab;
+   vocab = 0;
+   if (oldpaths) delete oldpaths;
+   if (oldmap) zfree(oldmap);
+   if (files) zfree(files);
+   if (newtoks) zfree(newtoks);
+   if (newvocab) zfree(newvocab);
+   zfree(walked);
+   Zarena_close(&arena);
+   index_close(old);
+   return err;
+}
+
+
+//  match search or ignore string with token, as recsearch() does
+//  returns 1 if matched
+
+int index_names::index_match(cchar *pattern, cchar *token)
+{
+   char     fold[1000];
+   int      cc = strlen(token);
+
+   if (Futf8 && ! utf8_ascii(token,cc)) {                                        //  Unicode token
+      if (FignorecaseS) {
+         utf8_fold(fold,token,1000);
+         token = fold;
+      }
+      return MatchWildUTF8(pattern,token) == 0;
+   }
+
+   if (FignorecaseS) return MatchWildFold(pattern,token) == 0;                   //  string is folded
+   return MatchWild(pattern,token) == 0;
+}
+
+
+//  search files with the index of the search path
+//  fid: search hits file for the files found
+//  returns count of files found, or -1 if the index cannot be used
+
+int index_search(FILE *fid)                                                      //  2.8
+{
+   using namespace index_names;
+
+   fwindex     fx;
+   idxevent    *events = 0, *events2, *ev;
+   const uchar *ip, *ipend;
+   char        root[XFCC], key[XFCC+200], file[XFCC], wpath[XFCC];
+   char        prefix[Tmax];
+   cchar       *pattern, *tok, *path, *pname;
+   int         Nev = 0, Mev = 0, ntok, lo, hi, mid, first, last, cc;
+   int         ii, jj, ss, tt, filenum, line, nfound = 0, fcount = 0, lcount;
+   int         Rmatch[Smax], Rignore[Smax], Fmatch[Smax], Fignore[Smax];
+   int         recmatch, recignore, filematch, reject, Nmtok = 0;
+   int         *fmatch = 0, *found = 0;
+   uint64      vv;
+   double      time0;
+
+   if (nsrs == 0) {                                                              //  every file matches
+      log_append(0," index: no search string, files are searched \n");
+      return -1;
+   }
+
+   if (FignorecaseS)                                                             //  letters as delimiters: folding
+      for (ii = 0; delims[ii]; ii++)                                             //    changes the tokens
+         if (isalpha(delims[ii])) {
+            log_append(0," index: letters in delimiters, files are searched \n");
+            return -1;
+         }
+
+   index_file(root,key,file);
+
+   if (Findex == 2 || index_open(fx,file,key)) {                                 //  update index, or make new index
+      if (index_update(root,key,file)) return -1;
+      if (killsearch) return 0;
+      if (index_open(fx,file,key)) return -1;
+   }
+
+   time0 = get_seconds();
+   ntok = fx.head->ntokens;
+
+   for (ss = 0; ss < nsrs + nigs; ss++)                                          //  search strings, then ignore strings
+   {
+      pattern = (ss < nsrs) ? srstrings[ss] : igstrings[ss-nsrs];
+
+      for (cc = 0; pattern[cc] && pattern[cc] != '*' && pattern[cc] != '?'; cc++)
+         prefix[cc] = zfoldcase[(uchar) pattern[cc]];                            //  literal start, folded
+
+      first = 0;
+      last = ntok;
+      if (cc && ! (Futf8 && FignorecaseS)) {                                     //  (Unicode folding may change
+         lo = 0;                                                                 //    the first bytes)
+         hi = ntok;
+         while (lo < hi) {                                                       //  first token >= prefix
+            mid = (lo + hi) / 2;
+            if (foldcompN(fx.tokens + fx.vocab[mid].str,prefix,cc) < 0) lo = mid + 1;
+            else hi = mid;
+         }
+         first = last = lo;
+         while (last < ntok && foldcompN(fx.tokens + fx.vocab[last].str,prefix,cc) == 0)
+            last++;                                                              //  tokens starting with prefix
+      }
+
+      for (tt = first; tt < last; tt++)
+      {
+         tok = fx.tokens + fx.vocab[tt].str;
+         if (! index_match(pattern,tok)) continue;
+         Nmtok++;
+
+         ip = fx.posts + fx.vocab[tt].post;                                      //  add its records to events
+         ipend = ip + fx.vocab[tt].postcc;
+         filenum = -1;
+         line = 0;
+         while (ip < ipend) {
+            vv = getv(ip);
+            if (vv & 1) {
+               filenum += vv >> 1;
+               line = getv(ip);
+            }
+            else line += vv >> 1;
+            if (Nev == Mev) {
+               Mev = Mev ? 2 * Mev : 4096;
+               events2 = (idxevent *) zmalloc(Mev * sizeof(idxevent),0);
+               if (Nev) memcpy(events2,events,Nev * sizeof(idxevent));
+               if (events) zfree(events);
+               events = events2;
+            }
+            events[Nev].file = filenum;
+            events[Nev].line = line;
+            events[Nev].str = ss;
+            Nev++;
+         }
+      }
+   }
+
+   if (Nev > 1) HeapSort((char *) events,sizeof(idxevent),Nev,evcomp);           //  by file, record
+
+   fmatch = (int *) zmalloc((fx.head->nfiles + 1) * sizeof(int));                //  match count per file, 0 = none
+   found = (int *) zmalloc((fx.head->nfiles + 1) * sizeof(int));                 //  walk order >> file id + 1
+
+   for (ii = 0; ii < Nev; )                                                      //  apply rules per file and record,
+   {                                                                             //    same as filesearch()
+      filenum = events[ii].file;
+      for (jj = 0; jj < Smax; jj++) Fmatch[jj] = Fignore[jj] = 0;
+      filematch = reject = 0;
+
+      while (ii < Nev && events[ii].file == filenum)
+      {
+         line = events[ii].line;
+         for (jj = 0; jj < Smax; jj++) Rmatch[jj] = Rignore[jj] = 0;
+         recmatch = recignore = 0;
+
+         for ( ; ii < Nev && events[ii].file == filenum && events[ii].line == line; ii++) {
+            ev = &events[ii];
+            if (ev->str < nsrs) {
+               if (Rmatch[ev->str]++ == 0) recmatch++;
+            }
+            else if (Rignore[ev->str - nsrs]++ == 0) recignore++;
+         }
+
+         if (reject) continue;
+
+         if (nigs > 0) {
+            if (ignorerule == ignore_any && recignore > 0) reject = 1;
+            if (ignorerule == ignore_rec_all && recignore == nigs) reject = 1;
+            if (reject) continue;
+         }
+
+         if (recmatch > 0) {
+            if (matchrule == match_rec_all && recmatch < nsrs) recmatch = 0;
+            if (recignore > 0) {
+               if (ignorerule == ignore_match_any) recmatch = 0;
+               if (ignorerule == ignore_match_all && recignore == nigs) recmatch = 0;
+            }
+         }
+
+         if (recmatch > 0) {
+            filematch += recmatch;
+            for (jj = 0; jj < nsrs; jj++) Fmatch[jj] += Rmatch[jj];
+         }
+
+         if (recignore > 0)
+            for (jj = 0; jj < nigs; jj++) Fignore[jj] += Rignore[jj];
+      }
+
+      if (reject || filematch == 0) continue;
+
+      if (ignorerule == ignore_all && nigs > 0) {
+         for (jj = 0; jj < nigs; jj++) if (Fignore[jj] == 0) break;
+         if (jj == nigs) continue;
+      }
+
+      if (matchrule == match_all) {
+         for (jj = 0; jj < nsrs; jj++) if (Fmatch[jj] == 0) break;
+         if (jj < nsrs) continue;
+      }
+
+      fmatch[filenum] = filematch;                                               //  file found
+      found[fx.files[filenum].seq] = filenum + 1;                                //  (in walk order)
+      nfound++;
+   }
+
+   log_append(0," index: %ld files, %d tokens, %d tokens matched, %d files, %.3f secs \n",
+                  fx.head->nfiles, ntok, Nmtok, nfound, get_seconds() - time0);
+
+   for (ii = 0; ii < nsrf; ii++)                                                 //  files found per search file,
+   {                                                                             //    as in filescan()
+      strcpy(wpath,sr_path);
+      if (sr_path[strlen(sr_path)-1] == '*' && srfiles[ii][0] == '*')
+            strcat(wpath,srfiles[ii]+1);
+      else  strcat(wpath,srfiles[ii]);
+
+      for (jj = 0; jj < fx.head->nfiles; jj++)
+      {
+         if (! found[jj]) continue;
+         filenum = found[jj] - 1;
+         path = fx.paths + fx.files[filenum].path;
+
+         if (FignorecaseF ? MatchWildIgnoreCase(wpath,path)
+                          : MatchWild(wpath,path)) continue;                     //  not this search file
+         if (Fstats) stats.Nwalk++;
+
+         pname = strrchr(path,'/') + 1;
+         for (ss = 0; ss < nigf; ss++) {
+            if (MatchWild(igfiles[ss],pname) == 0) break;                        //  ignore file
+            if (MatchWild(igfiles[ss],path) == 0) break;
+         }
+         if (ss < nigf) {
+            if (Fstats) stats.Xname++;
+            continue;
+         }
+
+         if (dt_to > 0 && (fx.files[filenum].mtime < dt_from ||                  //  out of date range
+                           fx.files[filenum].mtime > dt_to)) {
+            if (Fstats) stats.Xdate++;
+            continue;
+         }
+
+         if (listmatch) lcount = filesearch(path);                               //  read file, list records
+         else {
+            lcount = fmatch[filenum];
+            if (Ffiles) log_append2(0," %s \n",path);                            //  file name only
+            else log_append2(0," %5d %s \n",lcount,path);
+            if (outformat) out_file(path,lcount);
+         }
+
+         if (lcount) {
+            fprintf(fid,"%s""\n",path);
+            if (Fhittime) hit_add();
+            fcount++;
+         }
+
+         if (killsearch) break;
+         zmainloop();
+      }
+
+      if (killsearch) break;
+   }
+
+   if (events) zfree(events);
+   zfree(fmatch);
+   zfree(found);
+   index_close(fx);
+   return fcount;
+}
+
+
+/**
+ * @brief load_file - load search criteria from a file
+ * @param zd
+ */
+void load_file(zdialog *zd){                                                    //  1.2
+  char     *file;
+  cchar    *dialogtitle = "load search criteria from file";
+  int      err;
+
+  file = zgetfile(dialogtitle,MWIN,"file",criteriaFile);                        //  get input file from user
+  if (! file) return;
+
+  err = load_file2(file);
+  if (err) {
+    zmessageACK(mWin,"error %s \n %s",strerror(err), file);
+    zfree(file);
+    return;
+  }
+
+  search_dialog_stuff(zd);                                                      //  stuff dialog with search criteria
+  return;
+}
+
+/**
+ * @brief load_file2 - load file function used by search dialog and initz. function
+ * @param file
+ * @return 0 if OK or 'errno' if not
+ */
+int load_file2(cchar *file){                                                     //  1.2
+  FILE     *fid;
+  char     *pp, buff[Tmax];
+  int      err;
+
+  fid = fopen(file,"r");                                                        //  open for read
+  if (! fid) return errno;
+
+  while (true)
+  {
+    pp = fgets_trim(buff,Tmax,fid,1);
+    if (! pp) break;
+
+    if (strmatchN(pp,"match rule ",11)) matchrule = atoi(pp+11);
+    if (strmatchN(pp,"ignore rule ",12)) ignorerule = atoi(pp+12);
+    if (strmatchN(pp,"search path ",12)) strcpy(sr_path,pp+12);
+    if (strmatchN(pp,"search file ",12)) strcpy(sr_file,pp+12);
+    if (strmatchN(pp,"search string ",14)) strcpy(sr_string,pp+14);
+    if (strmatchN(pp,"ignore files ",13)) strcpy(ig_file,pp+13);
+    if (strmatchN(pp,"ignore string ",14)) strcpy(ig_string,pp+14);
+    if (strmatchN(pp,"delimiters ",11)) strncpy0(delims,pp+11,100);
+    if (strmatchN(pp,"date from ",10)) strcpy(date_from,pp+10);
+    if (strmatchN(pp,"date to ",8)) strcpy(date_to,pp+8);
+    if (strmatchN(pp,"ignore case files ",18)) FignorecaseF = atoi(pp+18);      //  2.8
+    if (strmatchN(pp,"ignore case strings ",20)) FignorecaseS = atoi(pp+20);
+    if (strmatchN(pp,"utf8 mode ",10)) Futf8 = atoi(pp+10);
+    if (strmatchN(pp,"unique files ",13)) Funique = atoi(pp+13);
+    if (strmatchN(pp,"gitignore files ",16)) Fgitignore = atoi(pp+16);
+    if (strmatchN(pp,"compressed files ",17)) Funpack = atoi(pp+17);
+    if (strmatchN(pp,"archive files ",14)) Farchive = atoi(pp+14);
+  }
+
+  err = fclose(fid);
+  if (err) return errno;
+
+  strcpy(criteriaFile,file);                                                    //  update current file
+  return 0;
+}
+
+/**
+ * @brief save_file - save search criteria to a file
+ * @param zd
+ */
+void save_file(zdialog *zd){                                                    //  1.2
+
+  FILE     *fid;
+  char     *file;
+  cchar    *dialogtitle = "save search criteria to a file";
+  int      err;
+
+  search_dialog_fetch(zd);                                                      //  get search criteria from dialog
+
+  file = zgetfile(dialogtitle,MWIN,"save",criteriaFile);                        //  get output file from user
+  if (! file) return;
+
+  fid = fopen(file,"w");                                                        //  open for write
+  if (! fid) {
+    zmessageACK(mWin,"unable to open file %s",file);
+    zfree(file);
+    return;
+  }
+
+  fprintf(fid,"match rule %d \n",matchrule);                                    //  write search criteria to file
+  fprintf(fid,"ignore rule %d \n",ignorerule);
+  fprintf(fid,"search path %s \n",sr_path);
+  fprintf(fid,"search file %s \n",sr_file);
+  fprintf(fid,"search string %s \n",sr_string);
+  fprintf(fid,"ignore files %s \n",ig_file);
+  fprintf(fid,"ignore string %s \n",ig_string);
+  fprintf(fid,"delimiters %s \n",delims);
+  fprintf(fid,"date from %s \n",date_from);
+  fprintf(fid,"date to %s \n",date_to);
+  fprintf(fid,"ignore case files %d \n",FignorecaseF);                          //  2.8
+  fprintf(fid,"ignore case strings %d \n",FignorecaseS);
+  fprintf(fid,"utf8 mode %d \n",Futf8);
+  fprintf(fid,"unique files %d \n",Funique);
+  fprintf(fid,"gitignore files %d \n",Fgitignore);
+  fprintf(fid,"compressed files %d \n",Funpack);
+  fprintf(fid,"archive files %d \n",Farchive);
+  fprintf(fid,"\n");
+
+  err = fclose(fid);
+  if (err) {
+    zmessageACK(mWin,"file I/O error %s",file);
+    zfree(file);
+    return;
+  }
+
+  strcpy(criteriaFile,file);                                                    //  update current file
+  zfree(file);
+
+  return;
+  }
+
+/**
+ * @brief KBevent - supply unused zdialog callback function
+ * @param event
+ */
+void KBevent(GdkEventKey *event){
+  return;
+}
+
+
+
+
+
+/********************************************************************************
+
+   benchmark harness                                                             2.8
+
+   This is compiled only into the separate program findwild-bench (make bench)
+   and is not part of the installed findwild program.
+
+   findwild-bench [options]
+
+      --corpus DIR      corpus folder (default /tmp/findwild-corpus)
+      --files N         corpus file count (2000)
+      --depth N         max. folder depth (6)
+      --deeper P        probability that a file goes one folder level deeper (0.6)
+      --fanout N        subfolders per folder (8)
+      --lines N         mean records per file (200)
+      --linecc N        mean record length (60)
+      --vocab N         distinct tokens in the vocabulary (20000)
+      --hits P          fraction of records containing the hit token (0.002)
+      --seed N          random seed (1)
+      --runs N          end-to-end runs, the best run is reported (3)
+      --khits K         end-to-end: also report the time to the K-th file found (10)
+      --mintime S       min. seconds per microbenchmark (0.3)
+      --json FILE       JSON results file (findwild-bench.json, "-" = stdout)
+      --only X          do only: corpus, micro, e2e
+
+   The corpus is reproducible: the same parameters and seed make the same
+   files, byte for byte. An existing corpus with the same parameters is reused.
+   The parameters are kept in the file DIR.manifest next to the corpus folder.
+   Token frequencies are skewed: few tokens are very common, most are rare.
+   Record lengths and file sizes have exponential distributions.
+   The hit token "fwhit" is added to records with the given probability.
+
+   Microbenchmarks: MatchWild() with several pattern types, tokenizing with
+   the default delimiters, recsearch(), and the file walkers SearchWild()
+   ('find -L' process) and walk_next(). The walker is also run over the tree
+   DIR-prune, which has a large .git folder, with an ignore file pattern for
+   the .git folder, applied to each file found or used to skip the folder.
+   End-to-end: filescan() over the corpus, reporting files/sec, MB/sec,
+   the median and 99th percentile search time per file, and the time until
+   the first and the K-th matching file is found. The search output
+   (text report, listed records, JSON lines) goes to /dev/null.
+   The count search is also run with each folder walk order (--order),
+   which changes the time to the first hits but not the files found.
+
+***/
+
+#ifdef FWBENCH
+
+namespace bench_names
+{
+   char     corpus[XFCC] = "/tmp/findwild-corpus";                               //  parameters
+   int      nfiles = 2000, maxdepth = 6, fanout = 8;
+   int      lines = 200, linecc = 60, vocab = 20000;
+   double   deeper = 0.6, hits = 0.002, mintime = 0.3;
+   int      seed = 1, runs = 3, khits = 10;
+   char     json[XFCC] = "findwild-bench.json";
+   char     only[20] = "all";
+
+   uint64   rseed;                                                               //  random number seed
+   char     **words = 0;                                                         //  vocabulary
+   int64    cfiles = 0, cbytes = 0;                                              //  corpus file count and bytes
+   char     **samples = 0;                                                       //  sample records
+   int      nsamples = 20000;
+   int64    samplebytes = 0;
+   char     **tokens = 0;                                                        //  tokens in sample records
+   int      ntokens = 0;
+   cchar    *pattern = 0;                                                        //  pattern for MatchWild tests
+   char     *sampletext = 0;                                                     //  sample records joined by '\n'
+   int64    sink = 0;                                                            //  defeat optimizer
+
+   struct bresult {                                                              //  microbenchmark result
+      cchar    *name;
+      double   nsop;                                                             //  nanosecs per operation
+      double   mbps;                                                             //  MB/sec, if meaningful
+   };
+   bresult  micro[60];
+   int      nmicro = 0;
+
+   struct eresult {                                                              //  end-to-end result
+      cchar    *name;
+      int      fcount;                                                           //  files found
+      double   secs, fps, mbps;                                                  //  best run
+      double   p50, p99;                                                         //  per-file latency, microsecs
+      double   first, khit;                                                      //  time to first and K-th hit, millisecs
+   };
+   eresult  e2e[16];
+   int      ne2e = 0;
+
+   cchar    *dlist[9] = { " ", " ", " ", "(", ")", ", ", ";", ".", " = " };      //  delimiters used in records
+   cchar    *exts[4] = { "c", "h", "txt", "log" };                               //  file name extensions
+}
+
+void recsearch(char *buff, int Rmatch[], int nsrs, int Rignore[], int nigs, int &recmatch, int &recignore);
+
+
+//  random value 0.0 to 0.99999
+
+double bench_rand()
+{
+   using namespace bench_names;
+   return lrandz(&rseed) / 2147483648.0;
+}
+
+
+//  make the vocabulary of distinct tokens
+
+void bench_vocab()
+{
+   using namespace bench_names;
+
+   cchar    *syll[24] = { "a", "e", "i", "o", "u", "ka", "to", "re", "mi", "sa",
+                          "lo", "ne", "str", "buf", "cnt", "ptr", "len", "idx",
+                          "get", "set", "init", "_", "x", "tab" };
+   char     word[60];
+   int      ii, jj, ns;
+
+   rseed = seed;
+   words = (char **) zmalloc(vocab * sizeof(char *));
+
+   for (ii = 0; ii < vocab; ii++)
+   {
+      *word = 0;
+      ns = 1 + lrandz(&rseed) % 4;                                               //  1-4 syllables
+      for (jj = 0; jj < ns; jj++)
+         strcat(word,syll[lrandz(&rseed) % 24]);
+      if (bench_rand() < 0.1) *word = toupper(*word);                            //  some capitalized
+      if (bench_rand() < 0.1) sprintf(word + strlen(word),"%d",ii % 100);        //  some with digits
+      words[ii] = zstrdup(word);
+   }
+
+   return;
+}
+
+
+//  make one random record, return length
+
+int bench_record(char *rec, int maxcc)
+{
+   using namespace bench_names;
+
+   int      cc, target;
+   cchar    *word;
+
+   target = -log(1.0 - bench_rand()) * linecc;                                   //  exponential length distribution
+   if (target > maxcc - 20) target = maxcc - 20;
+
+   cc = 0;
+   if (bench_rand() < 0.3) cc = sprintf(rec,"   ");                             //  some indented
+
+   while (cc < target)
+   {
+      if (cc) cc += sprintf(rec+cc,"%s",dlist[lrandz(&rseed) % 9]);
+      word = words[int(vocab * pow(bench_rand(),3))];                            //  skewed token frequency
+      if (cc + (int) strlen(word) > maxcc - 20) break;
+      cc += sprintf(rec+cc,"%s",word);
+   }
+
+   if (bench_rand() < hits) cc += sprintf(rec+cc,", fwhit");                     //  hit token
+   rec[cc] = 0;
+   return cc;
+}
+
+
+//  make the corpus, or reuse an existing one made with the same parameters
+
+int bench_corpus()
+{
+   using namespace bench_names;
+
+   char     manifest[XFCC+20], parms[300], buff[300], path[XFCC], rec[2000];
+   int      ii, jj, depth, nrecs, cc;
+   FILE     *fid;
+   STATB    statb;
+
+   snprintf(parms,300,"files %d depth %d deeper %.3f fanout %d lines %d linecc %d vocab %d hits %.5f seed %d",
+                        nfiles, maxdepth, deeper, fanout, lines, linecc, vocab, hits, seed);
+   snprintf(manifest,XFCC+20,"%s.manifest",corpus);
+
+   fid = fopen(manifest,"r");                                                    //  existing corpus
+   if (fid) {
+      fgets_trim(buff,300,fid);
+      if (strmatch(buff,parms)) {                                                //  same parameters, reuse
+         cc = fscanf(fid,"%ld %ld",&cfiles,&cbytes);
+         fclose(fid);
+         if (cc == 2) {
+            printf("reuse corpus %s: %ld files %s \n",corpus,cfiles,formatKBMB(cbytes,3));
+            return 0;
+         }
+      }
+      else fclose(fid);
+      Qshell(0,0,"rm -f -R \"%s\"",corpus);                                      //  different, remove
+   }
+
+   else if (stat(corpus,&statb) == 0) {                                          //  no manifest, do not overwrite
+      printf("%s exists and is not a findwild corpus \n",corpus);
+      return 1;
+   }
+
+   printf("make corpus %s \n",corpus);
+   if (mkdir(corpus,0750)) {
+      printf("cannot create %s: %s \n",corpus,strerror(errno));
+      return 1;
+   }
+
+   rseed = seed + 1000;
+   cfiles = cbytes = 0;
+
+   for (ii = 0; ii < nfiles; ii++)
+   {
+      strncpy0(path,corpus,XFCC);
+      for (depth = 0; depth < maxdepth && bench_rand() < deeper; depth++) {      //  random folder depth
+         cc = strlen(path);
+         snprintf(path+cc,XFCC-cc,"/d%d",lrandz(&rseed) % fanout);
+         mkdir(path,0750);                                                       //  (may exist already)
+      }
+
+      cc = strlen(path);
+      snprintf(path+cc,XFCC-cc,"/f%06d.%s",ii,exts[lrandz(&rseed) % 4]);
+
+      fid = fopen(path,"w");
+      if (! fid) {
+         printf("cannot create %s: %s \n",path,strerror(errno));
+         return 1;
+      }
+
+      nrecs = 1 + -log(1.0 - bench_rand()) * lines;                              //  exponential file size distribution
+      if (nrecs > 20 * lines) nrecs = 20 * lines;
+
+      for (jj = 0; jj < nrecs; jj++) {
+         cc = bench_record(rec,2000);
+         fputs(rec,fid);
+         fputc('\n',fid);
+         cbytes += cc + 1;
+      }
+
+      fclose(fid);
+      cfiles++;
+   }
+
+   fid = fopen(manifest,"w");
+   if (! fid) return 1;
+   fprintf(fid,"%s\n%ld %ld\n",parms,cfiles,cbytes);
+   fclose(fid);
+
+   printf("corpus done: %ld files %s \n",cfiles,formatKBMB(cbytes,3));
+   return 0;
+}
+
+
+//  run a benchmark function for at least mintime seconds
+//  func(reps) does reps repetitions and returns the operation count
+//  returns nanoseconds per operation, and total secs and reps
+
+typedef int64 bench_func(int64 reps);
+
+double bench_run(bench_func *func, double &secs, int64 &reps)
+{
+   using namespace bench_names;
+
+   double   time0;
+   int64    ops;
+
+   func(1);                                                                      //  warm up
+
+   for (reps = 1; ; reps *= 2)
+   {
+      time0 = get_seconds();
+      ops = func(reps);
+      secs = get_seconds() - time0;
+      if (secs >= mintime || reps > (int64) 1 << 40) break;
+   }
+
+   if (ops < 1) ops = 1;
+   return secs * 1.0e9 / ops;
+}
+
+
+int64 bench_matchwild(int64 reps)                                                //  MatchWild() with one pattern
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+
+   for (rr = 0; rr < reps; rr++)
+   for (ii = 0; ii < ntokens; ii++)
+      sink += MatchWild(pattern,tokens[ii]);
+   return reps * ntokens;
+}
+
+
+int64 bench_matchwildcase(int64 reps)                                            //  MatchWildIgnoreCase()
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+
+   for (rr = 0; rr < reps; rr++)
+   for (ii = 0; ii < ntokens; ii++)
+      sink += MatchWildIgnoreCase(pattern,tokens[ii]);
+   return reps * ntokens;
+}
+
+
+int64 bench_matchwildfold(int64 reps)                                            //  MatchWildFold()
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+
+   for (rr = 0; rr < reps; rr++)
+   for (ii = 0; ii < ntokens; ii++)
+      sink += MatchWildFold(pattern,tokens[ii]);
+   return reps * ntokens;
+}
+
+
+int64 bench_tokenize(int64 reps)                                                 //  strtok() records
+{
+   using namespace bench_names;
+   int64    rr, ops = 0;
+   int      ii;
+   char     buff[2000], *pp;
+
+   for (rr = 0; rr < reps; rr++)
+   for (ii = 0; ii < nsamples; ii++) {
+      strncpy0(buff,samples[ii],2000);
+      for (pp = strtok(buff,delims); pp; pp = strtok(0,delims)) ops++;
+   }
+   return ops;
 }
 
-/**
- * @brief load_file - load search criteria from a file
- * @param zd
- */
-void load_file(zdialog *zd){                                                    //  1.2
-  char     *file;
-  cchar    *dialogtitle = "load search criteria from file";
-  int      err;
 
-  file = zgetfile(dialogtitle,MWIN,"file",criteriaFile);                        //  get input file from user
-  if (! file) return;
+int64 bench_memmem(int64 reps)                                                   //  memmem() sample text      2.8
+{
+   using namespace bench_names;
+   int64    rr, ops = 0;
+   cchar    *pp;
+   int      cc = strlen(pattern);
+
+   for (rr = 0; rr < reps; rr++)
+   for (pp = sampletext; (pp = (cchar *) memmem(pp,sampletext+samplebytes-pp,pattern,cc)); pp++) ops++;
+   sink += ops;
+   return reps;
+}
 
-  err = load_file2(file);
-  if (err) {
-    zmessageACK(mWin,"error %s \n %s",strerror(err), file);
-    zfree(file);
-    return;
-  }
 
-  search_dialog_stuff(zd);                                                      //  stuff dialog with search criteria
-  return;
+int64 bench_zmemmem(int64 reps)                                                  //  zmemmem() sample text     2.8
+{
+   using namespace bench_names;
+   int64    rr, ops = 0;
+   cchar    *pp;
+   int      cc = strlen(pattern);
+
+   for (rr = 0; rr < reps; rr++)
+   for (pp = sampletext; (pp = zmemmem(pp,sampletext+samplebytes-pp,pattern,cc,FignorecaseS)); pp++) ops++;
+   sink += ops;
+   return reps;
 }
 
-/**
- * @brief load_file2 - load file function used by search dialog and initz. function
- * @param file
- * @return 0 if OK or 'errno' if not
- */
-int load_file2(cchar *file){                                                     //  1.2
-  FILE     *fid;
-  char     *pp, buff[Tmax];
-  int      err;
 
-  fid = fopen(file,"r");                                                        //  open for read
-  if (! fid) return errno;
+int64 bench_recsearch(int64 reps)                                                //  recsearch() records
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii, Rmatch[Smax], Rignore[Smax], recmatch, recignore;
+
+   for (rr = 0; rr < reps; rr++)
+   for (ii = 0; ii < nsamples; ii++) {
+      recsearch(samples[ii],Rmatch,nsrs,Rignore,nigs,recmatch,recignore);
+      sink += recmatch;
+   }
+   return reps * nsamples;
+}
 
-  while (true)
-  {
-    pp = fgets_trim(buff,Tmax,fid,1);
-    if (! pp) break;
 
-    if (strmatchN(pp,"match rule ",11)) matchrule = atoi(pp+11);
-    if (strmatchN(pp,"ignore rule ",12)) ignorerule = atoi(pp+12);
-    if (strmatchN(pp,"search path ",12)) strcpy(sr_path,pp+12);
-    if (strmatchN(pp,"search file ",12)) strcpy(sr_file,pp+12);
-    if (strmatchN(pp,"search string ",14)) strcpy(sr_string,pp+14);
-    if (strmatchN(pp,"ignore files ",13)) strcpy(ig_file,pp+13);
-    if (strmatchN(pp,"ignore string ",14)) strcpy(ig_string,pp+14);
-    if (strmatchN(pp,"delimiters ",11)) strncpy0(delims,pp+11,100);
-    if (strmatchN(pp,"date from ",10)) strcpy(date_from,pp+10);
-    if (strmatchN(pp,"date to ",8)) strcpy(date_to,pp+8);
-  }
+int64 bench_recsearch_utf8(int64 reps)                                           //  recsearch() in UTF-8 mode
+{
+   int64    ops;
 
-  err = fclose(fid);
-  if (err) return errno;
+   Futf8 = 1;
+   delims_init();
+   ops = bench_recsearch(reps);
+   Futf8 = 0;
+   return ops;
+}
 
-  strcpy(criteriaFile,file);                                                    //  update current file
-  return 0;
+
+int64 bench_zmalloc_cc = 64;                                                     //  block size for zmalloc() tests
+
+int64 bench_zmalloc(int64 reps)                                                  //  zmalloc() + zfree(), 100 blocks
+{
+   int64    rr;
+   int      ii;
+   void     *blocks[100];
+
+   for (rr = 0; rr < reps; rr++) {
+      for (ii = 0; ii < 100; ii++) blocks[ii] = zmalloc(bench_zmalloc_cc);
+      for (ii = 0; ii < 100; ii++) zfree(blocks[ii]);
+   }
+   return reps * 100;
 }
 
-/**
- * @brief save_file - save search criteria to a file
- * @param zd
- */
-void save_file(zdialog *zd){                                                    //  1.2
 
-  FILE     *fid;
-  char     *file;
-  cchar    *dialogtitle = "save search criteria to a file";
-  int      err;
+int64 bench_zstrdup(int64 reps)                                                  //  zstrdup() + zfree() tokens
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+   char     *strings[100];
 
-  search_dialog_fetch(zd);                                                      //  get search criteria from dialog
+   for (rr = 0; rr < reps; rr++) {
+      for (ii = 0; ii < 100; ii++) strings[ii] = zstrdup(tokens[ii]);
+      for (ii = 0; ii < 100; ii++) zfree(strings[ii]);
+   }
+   return reps * 100;
+}
 
-  file = zgetfile(dialogtitle,MWIN,"save",criteriaFile);                        //  get output file from user
-  if (! file) return;
 
-  fid = fopen(file,"w");                                                        //  open for write
-  if (! fid) {
-    zmessageACK(mWin,"unable to open file %s",file);
-    zfree(file);
-    return;
-  }
+int64 bench_arena(int64 reps)                                                    //  Zarena_strdup() tokens + reset
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+   Zarena   arena = { 4096 };
 
-  fprintf(fid,"match rule %d \n",matchrule);                                    //  write search criteria to file
-  fprintf(fid,"ignore rule %d \n",ignorerule);
-  fprintf(fid,"search path %s \n",sr_path);
-  fprintf(fid,"search file %s \n",sr_file);
-  fprintf(fid,"search string %s \n",sr_string);
-  fprintf(fid,"ignore files %s \n",ig_file);
-  fprintf(fid,"ignore string %s \n",ig_string);
-  fprintf(fid,"delimiters %s \n",delims);
-  fprintf(fid,"date from %s \n",date_from);
-  fprintf(fid,"date to %s \n",date_to);
-  fprintf(fid,"\n");
+   for (rr = 0; rr < reps; rr++) {
+      for (ii = 0; ii < 100; ii++) Zarena_strdup(&arena,tokens[ii]);
+      Zarena_reset(&arena);
+   }
+   Zarena_close(&arena);
+   return reps * 100;
+}
 
-  err = fclose(fid);
-  if (err) {
-    zmessageACK(mWin,"file I/O error %s",file);
-    zfree(file);
-    return;
-  }
 
-  strcpy(criteriaFile,file);                                                    //  update current file
-  zfree(file);
+int64 bench_malloc(int64 reps)                                                   //  malloc() + free() for comparison
+{
+   int64    rr;
+   int      ii;
+   void     *blocks[100];
 
-  return;
-  }
+   for (rr = 0; rr < reps; rr++) {
+      for (ii = 0; ii < 100; ii++) blocks[ii] = malloc(bench_zmalloc_cc);
+      for (ii = 0; ii < 100; ii++) free(blocks[ii]);
+   }
+   return reps * 100;
+}
 
-/**
- * @brief KBevent - supply unused zdialog callback function
- * @param event
- */
-void KBevent(GdkEventKey *event){
-  return;
+
+int64 bench_hashadd(int64 reps)                                                  //  HashTab Add() all tokens
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+
+   for (rr = 0; rr < reps; rr++) {
+      HashTab  htab(40,ntokens / 2);                                             //  table has about ntokens/5 strings
+      for (ii = 0; ii < ntokens; ii++) sink += htab.Add(tokens[ii]);
+   }
+   return reps * ntokens;
 }
 
 
+int64 bench_hashfind(int64 reps)                                                 //  HashTab Find() all tokens
+{
+   using namespace bench_names;
+   int64    rr;
+   int      ii;
+   static HashTab  *htab = 0;
+
+   if (! htab) {
+      htab = new HashTab(40,ntokens / 2);
+      for (ii = 0; ii < ntokens; ii += 2) htab->Add(tokens[ii]);                 //  about half are found
+   }
+
+   for (rr = 0; rr < reps; rr++)
+   for (ii = 0; ii < ntokens; ii++) sink += htab->Find(tokens[ii]);
+   return reps * ntokens;
+}
+
+
+int         bench_qthreads = 1;                                                  //  threads for Zqueue tests
+Zqueue      bench_queue;
+
+void * bench_qput(void *arg)                                                     //  Zqueue producer thread
+{
+   int64    nn = (int64) arg;
+
+   for (int64 ii = 1; ii <= nn; ii++)
+      Zqueue_put(&bench_queue,(void *) ii,-1);
+   return 0;
+}
+
+
+void * bench_qget(void *arg)                                                     //  Zqueue consumer thread
+{
+   int64    nn = (int64) arg, sum = 0;
+
+   for (int64 ii = 0; ii < nn; ii++)
+      sum += (int64) Zqueue_get(&bench_queue,-1);
+   __atomic_add_fetch(&bench_names::sink,sum,__ATOMIC_RELAXED);
+   return 0;
+}
+
+
+int64 bench_zqueue(int64 reps)                                                   //  Zqueue put + get, 1-64 threads
+{
+   using namespace bench_names;
+   int64       nn = reps * 1000, rr;
+   int         ii, np;
+   pthread_t   tids[64];
+
+   if (bench_qthreads == 1) {                                                    //  one thread: put 100, get 100
+      for (rr = 0; rr < reps * 10; rr++) {
+         for (ii = 1; ii <= 100; ii++) Zqueue_put(&bench_queue,(void *) (int64) ii,-1);
+         for (ii = 0; ii < 100; ii++) sink += (int64) Zqueue_get(&bench_queue,-1);
+      }
+      return nn;
+   }
+
+   np = bench_qthreads / 2;                                                      //  half producers, half consumers
+   for (ii = 0; ii < np; ii++) {
+      tids[ii] = start_Jthread(bench_qput,(void *) nn);
+      tids[np+ii] = start_Jthread(bench_qget,(void *) nn);
+   }
+   for (ii = 0; ii < 2 * np; ii++) wait_Jthread(tids[ii]);
+   return nn * np;
+}
+
+
+int64 bench_walker(int64 reps)                                                   //  SearchWild() corpus
+{
+   using namespace bench_names;
+   int64    rr, ops = 0;
+   int      ftf;
+   char     wpath[XFCC+4];
+
+   snprintf(wpath,XFCC+4,"%s/*",corpus);
+
+   for (rr = 0; rr < reps; rr++) {
+      ftf = 1;
+      while (SearchWild(wpath,ftf)) ops++;
+   }
+   return ops;
+}
+
+
+int64 bench_filewalk(int64 reps)                                                 //  walk_next() corpus
+{
+   using namespace bench_names;
+   int64    rr, ops = 0;
+   filewalk walk;
+   char     wpath[XFCC+4];
+
+   snprintf(wpath,XFCC+4,"%s/*",corpus);
+
+   for (rr = 0; rr < reps; rr++) {
+      walk_open(walk,wpath,0);
+      while (walk_next(walk)) ops++;
+      walk_close(walk);
+   }
+   return ops;
+}
+
+
+//  tree with a large ignored subtree: DIR-prune next to the corpus,
+//  src/ with 64 files and .git/objects/00-ff/ with 16 files each
+
+char     bench_ptree[XFCC+10];
+char     *bench_pignore[1] = { (char *) "*/.git/*" };
+int      bench_nprune = 0;                                                       //  use bench_pignore to prune
+int64    bench_pdirs, bench_pentries;                                            //  last walk counts
+
+int bench_prunetree()
+{
+   using namespace bench_names;
+   char     path[XFCC+50];
+   int      ii, jj, fd;
+   STATB    statb;
+
+   snprintf(bench_ptree,XFCC+10,"%s-prune",corpus);
+   snprintf(path,XFCC+50,"%s/.git/objects/ff/15",bench_ptree);
+   if (stat(path,&statb) == 0) return 0;                                         //  exists
+
+   Qshell(0,0,"rm -f -R \"%s\"",bench_ptree);
+   snprintf(path,XFCC+50,"%s/src",bench_ptree);
+   if (Qshell(0,0,"mkdir -p \"%s\" \"%s/.git/objects\"",path,bench_ptree)) return 1;
+
+   for (ii = 0; ii < 64; ii++) {
+      snprintf(path,XFCC+50,"%s/src/file%02d.c",bench_ptree,ii);
+      fd = open(path,O_WRONLY|O_CREAT|O_TRUNC,0640);
+      if (fd < 0) return 1;
+      close(fd);
+   }
+
+   for (ii = 0; ii < 256; ii++) {
+      snprintf(path,XFCC+50,"%s/.git/objects/%02x",bench_ptree,ii);
+      if (mkdir(path,0750)) return 1;
+      for (jj = 0; jj < 16; jj++) {
+         snprintf(path,XFCC+50,"%s/.git/objects/%02x/%02d",bench_ptree,ii,jj);
+         fd = open(path,O_WRONLY|O_CREAT|O_TRUNC,0640);
+         if (fd < 0) return 1;
+         close(fd);
+      }
+   }
+
+   return 0;
+}
+
+
+int64 bench_prune(int64 reps)                                                    //  walk_next() + ignore file filter
+{                                                                                //    with or without folder pruning
+   int64    rr, ops = 0;
+   filewalk walk;
+   cchar    *file;
+   char     wpath[XFCC+14];
+
+   snprintf(wpath,XFCC+14,"%s/*",bench_ptree);
+
+   for (rr = 0; rr < reps; rr++) {
+      walk_open(walk,wpath,0);
+      walk.prune = bench_pignore;
+      walk.nprune = bench_nprune;
+      while ((file = walk_next(walk)))
+         if (MatchWild(bench_pignore[0],file) != 0) ops++;                       //  as filescan()
+      bench_pdirs = walk.Ndirs;
+      bench_pentries = walk.Nentries;
+      walk_close(walk);
+   }
+   return ops;
+}
+
+
+//  do one microbenchmark and save the result
+
+void bench_micro1(cchar *name, bench_func *func, int64 bytesperrep)
+{
+   using namespace bench_names;
+
+   double   nsop, secs;
+   int64    reps;
+
+   nsop = bench_run(func,secs,reps);
+   micro[nmicro].name = name;
+   micro[nmicro].nsop = nsop;
+   micro[nmicro].mbps = 0;
+   if (bytesperrep) micro[nmicro].mbps = bytesperrep * reps / secs / 1.0e6;
+   printf("   %-28s %10.1f ns/op",name,nsop);
+   if (bytesperrep) printf(" %10.1f MB/s",micro[nmicro].mbps);
+   printf("\n");
+   nmicro++;
+   return;
+}
+
+
+//  do all microbenchmarks
+
+void bench_micro()
+{
+   using namespace bench_names;
+
+   char     buff[2000], *pp;
+   int      ii, maxtokens;
+   int64    cc;
+
+   rseed = seed + 2000;                                                          //  sample records
+   samples = (char **) zmalloc(nsamples * sizeof(char *));
+   for (ii = 0; ii < nsamples; ii++) {
+      samplebytes += bench_record(buff,2000) + 1;
+      samples[ii] = zstrdup(buff);
+   }
+
+   maxtokens = 10 * nsamples;                                                    //  tokens in sample records
+   tokens = (char **) zmalloc(maxtokens * sizeof(char *));
+   for (ii = 0; ii < nsamples && ntokens < maxtokens; ii++) {
+      strncpy0(buff,samples[ii],2000);
+      for (pp = strtok(buff,delims); pp && ntokens < maxtokens; pp = strtok(0,delims))
+         tokens[ntokens++] = zstrdup(pp);
+   }
+
+   printf("microbenchmarks: %d records, %d tokens \n",nsamples,ntokens);
+
+   pattern = "fwhit";
+   bench_micro1("MatchWild literal",bench_matchwild,0);
+   pattern = "get*";
+   bench_micro1("MatchWild prefix*",bench_matchwild,0);
+   pattern = "*buf*";
+   bench_micro1("MatchWild *infix*",bench_matchwild,0);
+   pattern = "*e*t?r*";
+   bench_micro1("MatchWild *a*b?c*",bench_matchwild,0);
+   pattern = "*BUF*";
+   bench_micro1("MatchWildIgnoreCase *infix*",bench_matchwildcase,0);
+   pattern = "*buf*";
+   bench_micro1("MatchWildFold *infix*",bench_matchwildfold,0);
+   bench_micro1("tokenize (strtok)",bench_tokenize,samplebytes);
+
+   sampletext = (char *) zmalloc(samplebytes+1);                                 //  literal scan of joined records
+   for (ii = 0, cc = 0; ii < nsamples; ii++) {
+      strcpy(sampletext+cc,samples[ii]);
+      cc += strlen(samples[ii]);
+      sampletext[cc++] = '\n';
+   }
+   pattern = "fwhit";
+   FignorecaseS = false;
+   bench_micro1("literal scan (memmem)",bench_memmem,samplebytes);
+   bench_micro1("literal scan (zmemmem)",bench_zmemmem,samplebytes);
+   FignorecaseS = true;
+   bench_micro1("literal scan ignore case",bench_zmemmem,samplebytes);
+   FignorecaseS = false;
+
+   srstrings[0] = zstrdup("fwhit");                                              //  recsearch() criteria
+   nsrs = 1;
+   nigs = 0;
+   order_init();
+   FignorecaseS = false;
+   bench_micro1("recsearch",bench_recsearch,samplebytes);
+   FignorecaseS = true;
+   bench_micro1("recsearch ignore case",bench_recsearch,samplebytes);
+   bench_micro1("recsearch UTF-8 ignore case",bench_recsearch_utf8,samplebytes);
+   FignorecaseS = false;
+
+   srstrings[1] = zstrdup("*buf*");                                              //  4 search strings,
+   srstrings[2] = zstrdup("get*");                                               //    without and with
+   srstrings[3] = zstrdup("*e*t?r*");                                            //      token match cache
+   nsrs = 4;
+   order_init();
+   Fmemo = 0;
+   bench_micro1("recsearch 4 strings",bench_recsearch,samplebytes);
+   Fmemo = 1;
+   Fstats = 1;
+   stats.Nmemo = stats.Hmemo = 0;
+   bench_micro1("recsearch 4 strings, cache",bench_recsearch,samplebytes);
+   Fstats = 0;
+   printf("   (token cache hits %.1f %%) \n",100.0 * stats.Hmemo / (stats.Nmemo + 1));
+   nsrs = 1;
+   order_init();
+
+   bench_micro1("walker (SearchWild)",bench_walker,0);
+   bench_micro1("walker (walk_next)",bench_filewalk,0);
+
+   if (bench_prunetree() == 0) {                                                 //  ignore */.git/*, 4096 files
+      int64    dirs0, entries0;
+      bench_nprune = 0;
+      bench_micro1("walker ignore .git, filter",bench_prune,0);
+      dirs0 = bench_pdirs;
+      entries0 = bench_pentries;
+      bench_nprune = 1;
+      bench_micro1("walker ignore .git, prune",bench_prune,0);
+      printf("   (ns/op per file found; folders read %ld -> %ld, entries read %ld -> %ld) \n",
+                  dirs0, bench_pdirs, entries0, bench_pentries);
+   }
+
+   bench_zmalloc_cc = 64;
+   bench_micro1("malloc+free 64",bench_malloc,0);
+   bench_micro1("zmalloc+zfree 64",bench_zmalloc,0);
+   bench_zmalloc_cc = 1000;
+   bench_micro1("zmalloc+zfree 1000",bench_zmalloc,0);
+   bench_zmalloc_cc = 100000;
+   bench_micro1("zmalloc+zfree 100000",bench_zmalloc,0);
+   bench_micro1("zstrdup+zfree",bench_zstrdup,0);
+   bench_micro1("Zarena_strdup+reset",bench_arena,0);
+   bench_micro1("HashTab Add tokens",bench_hashadd,0);
+   bench_micro1("HashTab Find tokens",bench_hashfind,0);
+
+   cchar *qnames[7] = { "Zqueue put+get 1 thread", "Zqueue put+get 2 threads",    //  contention, 1 CPU per thread
+                        "Zqueue put+get 4 threads", "Zqueue put+get 8 threads",   //    or less
+                        "Zqueue put+get 16 threads", "Zqueue put+get 32 threads",
+                        "Zqueue put+get 64 threads" };
+   Zqueue_open(&bench_queue,1024);
+   for (ii = 0, bench_qthreads = 1; bench_qthreads <= 64; ii++, bench_qthreads *= 2)
+      bench_micro1(qnames[ii],bench_zqueue,0);
+   Zqueue_close(&bench_queue);
+   return;
+}
+
+
+//  end-to-end search of the corpus, best of N runs
+
+void bench_e2e1(cchar *name, int list, int format)
+{
+   using namespace bench_names;
+
+   double   time0, secs, tt, best = 0, first = 0, khit = 0;
+   double   *lat = 0;
+   int      run, fcount = 0, nlat = 0;
+   eresult  *er = &e2e[ne2e++];
+
+   for (run = 0; run < runs; run++)
+   {
+      snprintf(sr_path,Tmax,"%s/*",corpus);                                      //  (filescan() destroys these)
+      strcpy(sr_file,"*");
+      strcpy(sr_string,"fwhit");
+      *ig_file = *ig_string = 0;
+      strcpy(delims,defaultdelims);
+      matchrule = match_any;
+      ignorerule = ignore_any;
+      listmatch = list;
+      listprec = listfoll = list ? 2 : 0;
+      outformat = format;
+      Fhits = 0;
+
+      Nlatency = Nhittime = 0;
+      time0 = get_seconds();
+      fcount = filescan();
+      secs = get_seconds() - time0;
+
+      if (Nhittime) {                                                            //  time to first and K-th hit,
+         tt = Fhittime[0] - time0;                                               //    or to the last if fewer,
+         if (run == 0 || tt < first) first = tt;                                 //      best of the runs
+         tt = Fhittime[Nhittime-1] - time0;
+         if (run == 0 || tt < khit) khit = tt;
+      }
+
+      if (run == 0 || secs < best) {                                             //  keep best run
+         best = secs;
+         zfree(lat);
+         lat = (double *) zmalloc((Nlatency + 1) * sizeof(double));
+         memcpy(lat,Flatency,Nlatency * sizeof(double));
+         nlat = Nlatency;
+      }
+   }
+
+   if (nlat > 1) HeapSort(lat,nlat);
+
+   er->name = name;
+   er->fcount = fcount;
+   er->secs = best;
+   er->fps = nlat / best;
+   er->mbps = cbytes / best / 1.0e6;
+   er->p50 = nlat ? lat[nlat / 2] * 1.0e6 : 0;
+   er->p99 = nlat ? lat[nlat * 99 / 100] * 1.0e6 : 0;
+   er->first = first * 1000;
+   er->khit = khit * 1000;
+   zfree(lat);
+
+   printf("   %-10s %6d found %8.3f secs %10.0f files/s %8.1f MB/s  p50 %8.1f us  p99 %8.1f us"
+          "  first %7.2f ms  %d hits %7.2f ms \n",
+              name, fcount, best, er->fps, er->mbps, er->p50, er->p99, er->first, khits, er->khit);
+   return;
+}
+
+
+void bench_e2e()
+{
+   using namespace bench_names;
+
+   char     root[XFCC], key[XFCC+200], file[XFCC];
+
+   Fbatch = 1;                                                                   //  search output >> /dev/null
+   outfid = fopen("/dev/null","w");
+   if (! outfid) return;
+   snprintf(hitsFile,1000,"%s.hits",corpus);
+   Flatency = (double *) zmalloc(10000 * sizeof(double));                        //  record per-file latency
+   Mlatency = 10000;
+   Fhittime = (double *) zmalloc(khits * sizeof(double));                        //  record time of first K hits
+   Mhittime = khits;
+
+   printf("end-to-end: %ld files %s, %d runs \n",cfiles,formatKBMB(cbytes,3),runs);
+   bench_e2e1("count",0,out_text);
+   bench_e2e1("list",1,out_text);
+   bench_e2e1("jsonl",1,out_jsonl);
+   Ffiles = 1;
+   bench_e2e1("files-with-matches",0,out_text);
+   Ffiles = 0;
+
+   walkorder = walk_bfs;                                                         //  folder walk orders
+   bench_e2e1("order-breadth",0,out_text);
+   walkorder = walk_recent;
+   bench_e2e1("order-recent",0,out_text);
+   walkorder = walk_small;
+   bench_e2e1("order-small",0,out_text);
+   walkorder = walk_dfs;
+
+   snprintf(indexDir,1000,"%s.index",corpus);                                    //  token index of corpus,
+   snprintf(sr_path,Tmax,"%s/*",corpus);                                         //    made before timing
+   index_file(root,key,file);
+   index_update(root,key,file);
+   Findex = 1;
+   bench_e2e1("index",0,out_text);
+   bench_e2e1("index-list",1,out_text);
+   Findex = 0;
+   outformat = out_text;
+
+   fclose(outfid);
+   return;
+}
+
+
+//  write all results in JSON format
+
+void bench_json()
+{
+   using namespace bench_names;
+
+   FILE     *fid;
+   char     date[40];
+   int      ii;
+
+   if (strmatch(json,"-")) fid = stdout;
+   else fid = fopen(json,"w");
+   if (! fid) {
+      printf("cannot write %s: %s \n",json,strerror(errno));
+      return;
+   }
+
+   pretty_datetime(time(0),date);
+
+   fprintf(fid,"{\n");
+   fprintf(fid,"  \"version\": \"%s\",\n",findwild_release);
+   fprintf(fid,"  \"date\": \"%s\",\n",date);
+   fprintf(fid,"  \"cpus\": %d,\n",get_nprocs());
+   fprintf(fid,"  \"corpus\": { \"path\": ");
+   json_string(fid,corpus);
+   fprintf(fid,", \"files\": %ld, \"bytes\": %ld, \"seed\": %d, \"depth\": %d, \"deeper\": %.3f,"
+               " \"fanout\": %d, \"lines\": %d, \"linecc\": %d, \"vocab\": %d, \"hits\": %.5f },\n",
+               cfiles, cbytes, seed, maxdepth, deeper, fanout, lines, linecc, vocab, hits);
+
+   fprintf(fid,"  \"micro\": [");
+   for (ii = 0; ii < nmicro; ii++)
+      fprintf(fid,"%s\n    { \"name\": \"%s\", \"ns_per_op\": %.2f, \"MB_per_sec\": %.2f }",
+                  ii ? "," : "", micro[ii].name, micro[ii].nsop, micro[ii].mbps);
+   fprintf(fid,"\n  ],\n");
+
+   fprintf(fid,"  \"e2e\": [");
+   for (ii = 0; ii < ne2e; ii++)
+      fprintf(fid,"%s\n    { \"name\": \"%s\", \"runs\": %d, \"found\": %d, \"secs\": %.4f,"
+                  " \"files_per_sec\": %.1f, \"MB_per_sec\": %.2f, \"p50_usec\": %.1f, \"p99_usec\": %.1f,"
+                  " \"first_hit_ms\": %.3f, \"k_hits\": %d, \"k_hits_ms\": %.3f }",
+                  ii ? "," : "", e2e[ii].name, runs, e2e[ii].fcount, e2e[ii].secs,
+                  e2e[ii].fps, e2e[ii].mbps, e2e[ii].p50, e2e[ii].p99,
+                  e2e[ii].first, khits, e2e[ii].khit);
+   fprintf(fid,"\n  ]\n}\n");
+
+   if (fid != stdout) {
+      fclose(fid);
+      printf("results: %s \n",json);
+   }
+   return;
+}
+
+
+//  benchmark main program
+
+int bench_main(int argc, char *argv[])
+{
+   using namespace bench_names;
+
+   int      ii, err = 0;
+   cchar    *opt, *val;
+
+   for (ii = 1; ii < argc; ii++)                                                 //  parse options
+   {
+      opt = argv[ii];
+      val = (ii+1 < argc) ? argv[++ii] : "";
+      if (strmatch(opt,"--corpus")) strncpy0(corpus,val,XFCC);
+      else if (strmatch(opt,"--files")) err = convSI(val,nfiles,1,10000000);
+      else if (strmatch(opt,"--depth")) err = convSI(val,maxdepth,0,100);
+      else if (strmatch(opt,"--deeper")) err = convSD(val,deeper,0,1);
+      else if (strmatch(opt,"--fanout")) err = convSI(val,fanout,1,10000);
+      else if (strmatch(opt,"--lines")) err = convSI(val,lines,1,10000000);
+      else if (strmatch(opt,"--linecc")) err = convSI(val,linecc,1,1900);
+      else if (strmatch(opt,"--vocab")) err = convSI(val,vocab,1,10000000);
+      else if (strmatch(opt,"--hits")) err = convSD(val,hits,0,1);
+      else if (strmatch(opt,"--seed")) err = convSI(val,seed,0,2000000000);
+      else if (strmatch(opt,"--runs")) err = convSI(val,runs,1,1000);
+      else if (strmatch(opt,"--khits")) err = convSI(val,khits,1,1000000);
+      else if (strmatch(opt,"--mintime")) err = convSD(val,mintime,0.001,100);
+      else if (strmatch(opt,"--json")) strncpy0(json,val,XFCC);
+      else if (strmatch(opt,"--only")) strncpy0(only,val,20);
+      else err = 1;
+      if (err) {
+         printf("invalid option: %s %s \n",opt,val);
+         return 2;
+      }
+   }
+
+   ii = strlen(corpus);                                                          //  no trailing '/'
+   if (ii > 1 && corpus[ii-1] == '/') corpus[ii-1] = 0;
+
+   strcpy(delims,defaultdelims);
+   bench_vocab();
+
+   if (bench_corpus()) return 1;                                                 //  make or reuse corpus
+   if (strmatch(only,"corpus")) return 0;
+
+   if (strmatch(only,"all") || strmatch(only,"micro")) bench_micro();
+   if (strmatch(only,"all") || strmatch(only,"e2e")) bench_e2e();
+
+   bench_json();
+   return 0;
+}
 
+#endif
@@ -104,10 +104,11 @@ typedef uint8_t      uchar ;
 
 //  system functions ============================================================
 
-void *zmalloc(size_t cc);                                                        //  malloc() wrapper
+void *zmalloc(size_t cc, int zero = 1);                                          //  malloc() wrapper, opt. no clear
 void zfree(void *pp);                                                            //  free() wrapper
 char *zstrdup(cchar *string, int addcc = 0);                                     //  strdup() wrapper with opt. expand
 void zmalloc_report();                                                           //  print statistics report
+void zmalloc_counts(int64 counts[6]);                                            //  get allocation counters
 void printz(cchar *format, ...);                                                 //  printf() with immediate fflush()
 void zexit(cchar *message, ...);                                                 //  exit a process and kill child processes
 void zbacktrace();                                                               //  produce a backtrace to stdout
@@ -173,6 +174,7 @@ cchar * strField(cchar *string, cchar delim, int Nth);
 int  strParms(int &bf, cchar *inp, char *pname, int maxcc, double &pval);        //  parse string: name1=val1 | name2 ...
 int  strHash(cchar *string, int max);                                            //  string --> random int 0 to max-1
 int64  strHash64(cchar *string, int64 max);                                      //  string --> random int 0 to max-1
+uint64 zhash64(const void *data, size_t cc, uint64 seed = 0);                    //  64-bit hash of data (wyhash)
 int  strncpy0(char *dest, cchar *source, uint cc);                               //  strncpy, insure null, return 0 if fit
 void strnPad(char *dest, cchar *source, int cc);                                 //  strncpy with blank padding to cc
 int  strTrim(char *dest, cchar *source);                                         //  remove trailing blanks
@@ -187,6 +189,9 @@ void strToUpper(char *dest, cchar *source);
 void strToUpper(char *string);                                                   //  conv. string to upper case
 void strToLower(char *dest, cchar *source);                                      //  move and conv. string to lower case
 void strToLower(char *string);                                                   //  conv. string to lower case
+extern const uchar zfoldcase[256];                                               //  case fold table, 'A' >> 'a'
+void strFold(char *dest, cchar *source, int maxcc);                              //  copy and fold to lower case, max. cc
+cchar * zmemmem(cchar *data, size_t cc, cchar *str, int scc, int fold);          //  memmem(), opt. ignore case (folded str)
 int  repl_1str(cchar *strin, char *strout, cchar *ssin, cchar *ssout);           //  copy string and replace 1 substring
 int  repl_Nstrs(cchar *strin, char *strout, ...);                                //  copy string and replace N substrings
 int  breakup_text(cchar *in, char **&out, cchar *dlm, int cc1, int cc2);         //  break long string into substrings
@@ -198,6 +203,12 @@ int  utf8len(cchar *utf8string);
 int  utf8substring(char *utf8out, cchar *utf8in, int pos, int cc);               //  get graphic substring from UTF8 string
 int  utf8_check(cchar *string);                                                  //  check utf8 string for encoding errors
 int  utf8_position(cchar *utf8in, int Nth);                                      //  get byte position of Nth graphic char.
+int  utf8_decode(cchar *string, int &cc);                                        //  get code point and byte count
+int  utf8_encode(int code, char *string);                                        //  code point to UTF-8, returns cc
+int  utf8_foldcode(int code);                                                    //  simple Unicode case folding
+int  utf8_fold(char *dest, cchar *source, int maxcc);                            //  copy and fold string, returns cc
+int  utf8_class(int code);                                                       //  0 = other, 1 = space, 2 = punctuation
+int  utf8_ascii(cchar *string, int cc);                                          //  1 if all bytes are ASCII
 int  zsed(cchar *file, ...);                                                     //  replace string1/3... with string2/4...
 cchar * zstrstr(cchar *haystack, cchar *needle);                                 //  work like strstr() and strcasestr()
 cchar * zstrcasestr(cchar *haystack, cchar *needle);                             //  (but "" does NOT match any string)
@@ -218,6 +229,8 @@ char * formatKBMB(double fnum, int prec);
 
 int MatchWild(cchar * wildstr, cchar * str);                                     //  wildcard string match (match = 0)
 int MatchWildIgnoreCase(cchar * wildstr, cchar * str);                           //  wildcard string match, ignoring case
+int MatchWildFold(cchar * wildstr, cchar * str);                                 //  same, wildstr already lower case
+int MatchWildUTF8(cchar * wildstr, cchar * str);                                 //  wildcard match, '?' = 1 UTF-8 char.
 cchar * SearchWild(cchar *wpath, int &flag);                                     //  wildcard file search
 cchar * SearchWildCase(cchar *wpath, int &flag);                                 //  wildcard file search, ignoring case
 int zfind(cchar *pattern, char **&flist, int &NF);                               //  wildcard file search using glob()
@@ -270,14 +283,33 @@ uint32 lrandz();
 void spline1(int nn, float *dx, float *dy);                                      //  define a curve using nn data points
 float spline2(float x);                                                          //  return y-value for given x-value
 
-//  FIFO queue for text strings, single or dual-thread access ===================
+//  bounded FIFO queue of pointers, lock-free, any number of threads ============
+
+struct zqcell;                                                                   //  queue cell
+
+typedef struct  {
+   int      qcap;                                                                //  queue capacity, power of 2
+   int      qdone;                                                               //  flag, no more entries coming
+   zqcell   *cells;                                                              //  qcap cells, circular
+   alignas(64) uint64 qput;                                                      //  next put position
+   alignas(64) uint64 qget;                                                      //  next get position
+   alignas(64) int putwake, getwake;                                             //  futex words for waiting threads
+   int      putwait, getwait;                                                    //  waiting thread counts
+}  Zqueue;
+
+void Zqueue_open(Zqueue *zq, int cap);                                           //  initialize queue, empty
+int Zqueue_put(Zqueue *zq, void *entry, double secs = -1);                       //  add entry, wait up to secs if full
+void * Zqueue_get(Zqueue *zq, double secs = -1);                                 //  remove oldest entry, wait if empty
+int Zqueue_count(Zqueue *zq);                                                    //  get current entry count
+void Zqueue_done(Zqueue *zq);                                                    //  no more entries, wake waiting threads
+void Zqueue_close(Zqueue *zq);                                                   //  free queue memory
+
+//  FIFO queue for text strings, multi-thread access ============================
 
 typedef struct  {
    int      qcap;                                                                //  queue capacity
-   int      qnewest;                                                             //  newest entry position, circular
-   int      qoldest;                                                             //  oldest entry position, circular
    int      qdone;                                                               //  flag, last entry added to queue
-   char     **qtext;                                                             //  up to qcap text strings
+   Zqueue   queue;                                                               //  text strings
 }  Qtext;
 
 void Qtext_open(Qtext *qtext, int cap);                                          //  initialize Qtext queue, empty
@@ -285,6 +317,23 @@ void Qtext_put(Qtext *qtext, cchar *format, ...);
 char * Qtext_get(Qtext *qtext);                                                  //  remove text string from Qtext queue
 void Qtext_close(Qtext *qtext);                                                  //  close Qtext, zfree() leftover strings
 
+//  arena allocator, one thread, release all allocations at once ================
+
+typedef struct  {
+   size_t   blockcc;                                                             //  normal block size
+   void     *blocks;                                                             //  block chain, current block first
+   char     *next;                                                               //  current block memory
+   size_t   used, cap;                                                           //  bytes used, available in block
+   int64    Nalloc;                                                              //  allocations, all time
+   int      Nblocks;                                                             //  blocks allocated now
+}  Zarena;
+
+void Zarena_open(Zarena *arena, size_t blockcc = 0);                             //  initialize arena, default 64 KB blocks
+void * Zarena_alloc(Zarena *arena, size_t cc);                                   //  allocate cc bytes, 16 byte aligned
+char * Zarena_strdup(Zarena *arena, cchar *string, int addcc = 0);               //  strdup() into arena
+void Zarena_reset(Zarena *arena);                                                //  release all, keep one block
+void Zarena_close(Zarena *arena);                                                //  release all memory
+
 //  application initialization and administration ===============================
 
 int appimage_install(cchar *appname);                                            //  make appimage desktop and icon files
@@ -720,21 +769,45 @@ public:
 
 //  hash table class ============================================================
 
-class HashTab
+struct zhslot;                                                                   //  Zhash table entry
+
+class Zhash                                                                      //  any keys, automatic growth
+{
+   uchar    * ctrl;                                                              //  control bytes[cap]
+   zhslot   * slots;                                                             //  entries[cap]
+   int      cap;                                                                 //  table capacity, power of 2
+   int      count;                                                               //  keys contained
+   int      ndel;                                                                //  deleted positions
+   Zarena   arena;                                                               //  key memory
+   int probe(const void * key, int cc, uint64 hash, int & free);                 //  find key position
+   void rehash(int newcap);                                                      //  rebuild table
+public:
+   Zhash(int cap = 0);                                                           //  constructor
+   ~Zhash();                                                                     //  destructor
+   int Put(const void * key, int cc, int & added);                               //  find or add key
+   int Find(const void * key, int cc);                                           //  find key
+   int Del(const void * key, int cc);                                            //  delete key
+   int Put(cchar * key, int & added) { return Put(key,strlen(key),added); };     //  string keys
+   int Find(cchar * key) { return Find(key,strlen(key)); };
+   int Del(cchar * key) { return Del(key,strlen(key)); };
+   int GetCount() { return count; };                                             //  get key count
+   int GetNext(int entry);                                                       //  next entry, -1 = first
+   cchar * Key(int entry, int * cc = 0);                                         //  get key of entry
+   int64 & Value(int entry);                                                     //  caller data of entry
+};
+
+class HashTab                                                                    //  fixed length strings
 {
-   static int tries1;                                                            //  insert tries
-   static int tries2;                                                            //  find/delete tries
-   int     cap;                                                                  //  table capacity
-   int     count;                                                                //  strings contained
-   int     cc;                                                                   //  string length
-   char  * table;                                                                //  table[cc][cap]
+   int     cc;                                                                   //  max. string length + 1
+   int     next;                                                                 //  GetNext() position
+   Zhash * table;
 public:
    HashTab(int cc, int cap);                                                     //  constructor
    ~HashTab();                                                                   //  destructor
    int Add(cchar * string);                                                      //  add a new string
    int Del(cchar * string);                                                      //  delete a string
    int Find(cchar * string);                                                     //  find a string
-   int GetCount() { return count; };                                             //  get string count
+   int GetCount() { return table->GetCount(); };                                 //  get string count
    int GetNext(int & first, char * string);                                      //  get first/next string
    int Dump();                                                                   //  dump hash table
 };
@@ -746,6 +819,7 @@ class  Queue
    char        wmi[8];
    Vxstring  * vd;                                                               //  vector of xstrings
    mutex_t     qmutex;                                                           //  for multi-thread access
+   pthread_cond_t qcond;                                                         //  wait for pop when full
    int         qcap;                                                             //  queue capacity
    int         qcount;                                                           //  curr. queue count
    int         ent1;                                                             //  first entry pointer